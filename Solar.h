@@ -1,22 +1,42 @@
 #ifndef SOLAR_H
 #define SOLAR_H
 
-#include <math.h>
-#include <stdint.h>
-#define DEBUG_PRINT
+#include "SolarCore.h"
+#include "SolarInstrument.h"
+// Define DEBUG_PRINT in the build (not here) to get DebugPrint(), nothing is printed unless you call it
 #ifdef DEBUG_PRINT
 #include <stdio.h>
 #endif
 
+//--------------------------------------------------------------------------------------------------
+struct SolarInstants {
+    // Structure-of-arrays of local (solar) date/times for Solar::SolarPositions(), one entry per instant
+    const int* Year;
+    const uint8_t* Month;
+    const uint8_t* Day;
+    const uint8_t* Hour;
+    const uint8_t* Minute;
+};
+//--------------------------------------------------------------------------------------------------
+#ifndef SOLAR_BATCH_BLOCK
+#ifdef ARDUINO
+#define SOLAR_BATCH_BLOCK 4     // instants per pass of SolarPositions(), sets the stack use (6 doubles each)
+#else
+#define SOLAR_BATCH_BLOCK 64
+#endif
+#endif
 //--------------------------------------------------------------------------------------------------
 class Solar {
     // A class to calculate the direction and elevation to the position of the sun
     // It can also be used to prove that the earth is NOT flat :-)
+    // Keeps a date/time and the last result of the stateless functions in SolarCore.h, one object per thread.
 public:
     Solar( double TimeZone, double Latitude, double Longitude );
-    void setDateTime( int Year, uint8_t Month, uint8_t Day, uint8_t Hour, uint8_t Minute );
+    void setDateTime( int Year, uint8_t Month, uint8_t Day, uint8_t Hour, uint8_t Minute, uint8_t Second = 0 );
     void setDate( int Year, uint8_t Month, uint8_t Day );
-    void setTime( uint8_t Hour, uint8_t Minute );
+    void setTime( uint8_t Hour, uint8_t Minute, uint8_t Second = 0 );
+    void setUnixTime( int64_t UnixTime );
+    int64_t getUnixTime( void );
     double SolarElevation( void );
     double SolarAzimuthAngle( void );
     double SunriseDegrees( void );
@@ -24,48 +44,43 @@ public:
     double SunsetTime( void );
     double SolarNoon( void );
     double SunsetDegrees( void );
+    double SunDeclination( void );
+    double EquationOfTime( void );
+    void SunEphemeris( double JulianDay, double& SunDeclin, double& EqOfTime );
+    void setEphemeris( const SolarEphemerisTable* Table );
     bool DayTime( void );
+    double MinutesToSunrise( void );
+    double MinutesToSunset( void );
+    bool ElevationCrossings( double Elevation, double& Rise, double& Set, bool Refracted = false );
+    int ElevationCrossingsYear( int Year, double Elevation, double* Rise, double* Set, bool Refracted = false );
+    void SolarPositions( const SolarInstants& Instants, int Count, double* Elevation, double* Azimuth, double* Zenith, double* Declination );
     void DateCalc( char part, int offset );
+    int GetYear( void );
+    uint8_t GetMonth( void );
+    uint8_t GetDay( void );
     uint8_t GetHours( void );
     uint8_t GetMinutes( void );
+    uint8_t GetSeconds( void );
     bool LeapYear( void );
 #ifdef DEBUG_PRINT
     void DebugPrint(void);
 #endif
 private:
-    long GregorianToJulian( int Year, uint8_t Month, uint8_t Day );
-    double DecimalDate( void );
     double DecimalTime( void );
     double JulianDay( void );
-    double JulianCentury( void );
-    double GeomMeanLongSun( void );
-    double GeomMeanAnomSun( void );
-    double EccentEarthOrbit( void );
-    double MeanObliqEcliptic( void );
-    double ObliqCorr( void );
-    double SunDeclin( void );
-    double VarY( void );
-    double SunAppLong( void );
-    double SunEqOfCtr( void );
-    double SunTrueLong( void );
-    double TrueSolarTime( void );
-    double HourAngle( void );
-    double SolarZenithAngle( void );
-    double EqOfTime( void );
-    double SolarElevationAngle( void );
-    double ApproxAtmosphericRefraction( void );
-#ifndef ARDUINO
-    double radians( double );
-    double degrees( double );
-#endif
-    double m_TimeZone;
-    double m_Latitude;
-    double m_Longitude;
-    int m_Year;
-    uint8_t m_Month;
-    uint8_t m_Day;
-    uint8_t m_Hour;
-    uint8_t m_Minute;
+    bool ElevationCrossing( int32_t DayNumber, double SinElevation, double Direction, double& Time );
+    const SolarPosition& State( void );
+    void UpdateState( void );
+    const SunEvents& Events( int32_t DayNumber );
+    SolarSite m_Site;
+    int32_t m_DayNumber;    // local (solar) date as days since 1970-01-01
+    int32_t m_Seconds;      // local (solar) time as seconds past midnight, 0 .. 86399
+    int32_t m_UnixOffset;   // time zone in whole seconds, keeps the date/time keeping free of floating point
+    const SolarEphemerisTable* m_Ephemeris;
+    SolarPosition m_State;  // of the set date/time, computed once on first read, azimuth left out
+    bool m_StateValid;
+    SunEvents m_Events[2];  // of two consecutive days, slot DayNumber & 1
+    int32_t m_EventsDay[2];
 };
 //--------------------------------------------------------------------------------------------------
 
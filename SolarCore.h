@@ -0,0 +1,291 @@
+#ifndef SOLARCORE_H
+#define SOLARCORE_H
+
+#include "SolarInstrument.h"
+#include <math.h>
+#include <stdint.h>
+
+// The NOAA chain as pure inline functions: a SolarSite and an instant go in, a SolarPosition or SunEvents comes out.
+// Nothing is kept between calls, so any number of threads can evaluate against one shared, read-only table of sites.
+// The Solar class is a wrapper that keeps a date/time and the last result, both give the very same numbers.
+// Trig of the chain goes through SolarSin() etc., which count in SolarCounters().TrigCalls with SOLAR_INSTRUMENT.
+//
+// An instant is a local (solar) date as days since 1970-01-01 and seconds past midnight, the way Solar stores it,
+// or seconds since 1970 UTC through the ...Unix() variants. SunEvents belong to the local day and are evaluated at its
+// 12:00, like Solar::SunriseTime(), whatever the time of day of the instant.
+
+//--------------------------------------------------------------------------------------------------
+struct SolarSite {
+    double TimeZone;
+    double Latitude;
+    double Longitude;
+    double SinLatitude;
+    double CosLatitude;
+    double TanLatitude;
+};
+//--------------------------------------------------------------------------------------------------
+struct SolarPosition {
+    double JulianCentury;
+    double SunDeclin;                   // degrees
+    double EqOfTime;                    // minutes
+    double HourAngle;                   // degrees
+    double SolarZenithAngle;            // degrees, without refraction
+    double ApproxAtmosphericRefraction; // degrees
+    double SolarElevation;              // degrees, corrected for refraction
+    double SolarAzimuthAngle;           // degrees clockwise from north
+};
+//--------------------------------------------------------------------------------------------------
+struct SunEvents {
+    double SunriseDegrees;  // hour angle of sunrise
+    double SunriseTime;     // fraction of the local day
+    double SolarNoon;
+    double SunsetTime;
+};
+//--------------------------------------------------------------------------------------------------
+class SolarEphemerisTable {
+    // Interface of a precomputed declination / equation of time table, see SolarEphemeris.h
+public:
+    virtual ~SolarEphemerisTable( void ) {}
+    virtual bool Lookup( double JulianDay, double& SunDeclin, double& EqOfTime ) const = 0;
+};
+//--------------------------------------------------------------------------------------------------
+inline double SolarRadians( double Degrees ) {
+    return Degrees * 3.141592654 / 180.0;
+}
+//--------------------------------------------------------------------------------------------------
+inline double SolarDegrees( double Radians ) {
+    return Radians * 180.0 / 3.141592654;
+}
+//--------------------------------------------------------------------------------------------------
+inline double SolarSin( double x ) {
+    SOLAR_COUNT( TrigCalls, 1 );
+    return sin( x );
+}
+inline double SolarCos( double x ) {
+    SOLAR_COUNT( TrigCalls, 1 );
+    return cos( x );
+}
+inline double SolarTan( double x ) {
+    SOLAR_COUNT( TrigCalls, 1 );
+    return tan( x );
+}
+inline double SolarAsin( double x ) {
+    SOLAR_COUNT( TrigCalls, 1 );
+    return asin( x );
+}
+inline double SolarAcos( double x ) {
+    SOLAR_COUNT( TrigCalls, 1 );
+    return acos( x );
+}
+//--------------------------------------------------------------------------------------------------
+inline SolarSite SolarMakeSite( double TimeZone, double Latitude, double Longitude ) {
+    SolarSite Site;
+    Site.TimeZone    = TimeZone;
+    Site.Latitude    = Latitude;
+    Site.Longitude   = Longitude;
+    Site.SinLatitude = sin( SolarRadians( Latitude ) );
+    Site.CosLatitude = cos( SolarRadians( Latitude ) );
+    Site.TanLatitude = tan( SolarRadians( Latitude ) );
+    return Site;
+}
+//--------------------------------------------------------------------------------------------------
+inline int32_t SolarDaysFromCivil( int Year, uint8_t Month, uint8_t Day ) { // days since 1970-01-01, proleptic Gregorian calendar
+    int32_t y   = ( int32_t ) Year - ( Month <= 2 ? 1 : 0 );
+    int32_t era = ( y >= 0 ? y : y - 399 ) / 400;
+    int32_t yoe = y - era * 400;                                                  // 0 .. 399
+    int32_t doy = ( 153 * ( Month > 2 ? Month - 3 : Month + 9 ) + 2 ) / 5 + Day - 1; // 0 .. 365, year starting March 1st
+    int32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;                         // 0 .. 146096
+    return era * 146097L + doe - 719468L;
+}
+//--------------------------------------------------------------------------------------------------
+inline void SolarCivilFromDays( int32_t Days, int& Year, uint8_t& Month, uint8_t& Day ) { // inverse of SolarDaysFromCivil()
+    Days += 719468L;
+    int32_t era = ( Days >= 0 ? Days : Days - 146096L ) / 146097L;
+    int32_t doe = Days - era * 146097L;
+    int32_t yoe = ( doe - doe / 1460 + doe / 36524 - doe / 146096 ) / 365;
+    int32_t doy = doe - ( 365 * yoe + yoe / 4 - yoe / 100 );
+    int32_t mp  = ( 5 * doy + 2 ) / 153;
+    Day   = doy - ( 153 * mp + 2 ) / 5 + 1;
+    Month = mp < 10 ? mp + 3 : mp - 9;
+    Year  = yoe + era * 400 + ( Month <= 2 ? 1 : 0 );
+}
+//--------------------------------------------------------------------------------------------------
+inline uint8_t SolarDaysInMonth( int Year, uint8_t Month ) {
+    static const uint8_t months[] = { 0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    bool Leap = ( Year % 4 == 0 ) && ( Year % 100 != 0 || Year % 400 == 0 );
+    return ( Month == 2 && Leap ) ? 29 : months[Month];
+}
+//--------------------------------------------------------------------------------------------------
+inline void SolarDateCalc( int32_t& DayNumber, int32_t& Seconds, char Part, int Offset ) {
+    // Moves a local day number and seconds past midnight by Offset years ('Y'), months ('M'), days ('D'), hours ('h'),
+    // minutes ('m') or seconds ('s') in constant time. Years and months keep the day of the month, clipped to the
+    // length of the new month.
+    int Year;
+    uint8_t Month, Day;
+    int32_t Months;
+    int64_t Total;
+    switch( Part ) {
+        case 'Y':
+        case 'M':
+            SolarCivilFromDays( DayNumber, Year, Month, Day );
+            Months = ( int32_t ) Year * 12 + ( Month - 1 ) + ( Part == 'Y' ? ( int32_t ) Offset * 12 : Offset );
+            Year   = ( Months >= 0 ? Months : Months - 11 ) / 12;
+            Month  = Months - ( int32_t ) Year * 12 + 1;
+            if( Day > SolarDaysInMonth( Year, Month ) ) {
+                Day = SolarDaysInMonth( Year, Month );
+            }
+            DayNumber = SolarDaysFromCivil( Year, Month, Day );
+            break;
+        case 'D':
+            DayNumber += Offset;
+            break;
+        case 'h':
+        case 'm':
+        case 's':
+            Total = Seconds + ( int64_t ) Offset * ( Part == 'h' ? 3600 : Part == 'm' ? 60 : 1 );
+            DayNumber += ( int32_t )( Total / 86400 );
+            Seconds    = ( int32_t )( Total % 86400 );
+            if( Seconds < 0 ) {
+                Seconds += 86400;
+                DayNumber--;
+            }
+            break;
+    }
+}
+//--------------------------------------------------------------------------------------------------
+inline int32_t SolarUnixOffset( double TimeZone ) { // time zone in whole seconds
+    return ( int32_t ) floor( TimeZone * 3600.0 + 0.5 );
+}
+//--------------------------------------------------------------------------------------------------
+inline int32_t SolarUnixOffset( const SolarSite& Site ) {
+    return SolarUnixOffset( Site.TimeZone );
+}
+//--------------------------------------------------------------------------------------------------
+inline void SolarLocalTime( int32_t UnixOffset, int64_t UnixTime, int32_t& DayNumber, int32_t& Seconds ) {
+    // Integer only, the offset comes from SolarUnixOffset()
+    int64_t Local = UnixTime + UnixOffset;
+    int64_t Days  = Local / 86400;
+    if( Local % 86400 < 0 ) {
+        Days--;
+    }
+    DayNumber = ( int32_t ) Days;
+    Seconds   = ( int32_t )( Local - Days * 86400 );
+}
+//--------------------------------------------------------------------------------------------------
+inline void SolarLocalTime( const SolarSite& Site, int64_t UnixTime, int32_t& DayNumber, int32_t& Seconds ) {
+    SolarLocalTime( SolarUnixOffset( Site ), UnixTime, DayNumber, Seconds );
+}
+//--------------------------------------------------------------------------------------------------
+inline double SolarJulianDay( const SolarSite& Site, int32_t DayNumber, int32_t Seconds ) {
+    return DayNumber + 2440587.5 + Seconds / 86400.0 - Site.TimeZone / 24.0;
+}
+//--------------------------------------------------------------------------------------------------
+inline void SolarSunEphemeris( double JulianCentury, double& SunDeclin, double& EqOfTime ) {
+    // Declination (degrees) and equation of time (minutes), the date dependent part of the chain with 15 trig calls
+    double T  = JulianCentury;
+    double L  = fmod( 280.46646 + T * ( 36000.76983 + T * 0.0003032 ), 360.0 );                 // GeomMeanLongSun
+    double M  = 357.52911 + T * ( 35999.05029 - 0.0001537 * T );                                 // GeomMeanAnomSun
+    double E  = 0.016708634 - T * ( 0.000042037 + 0.0000001267 * T );                            // EccentEarthOrbit
+    double Oc = 23.0 + ( 26.0 + ( ( 21.448 - T * ( 46.815 + T * ( 0.00059 - T * 0.001813 ) ) ) ) / 60.0 ) / 60.0 + 0.00256 * SolarCos( SolarRadians( 125.04 - 1934.136 * T ) );
+    double C  = SolarSin( SolarRadians( M ) ) * ( 1.914602 - T * ( 0.004817 + 0.000014 * T ) ) + SolarSin( SolarRadians( 2.0 * M ) ) * ( 0.019993 - 0.000101 * T ) + SolarSin( SolarRadians( 3.0 * M ) ) * 0.000289;
+    double A  = L + C - 0.00569 - 0.00478 * SolarSin( SolarRadians( 125.04 - 1934.136 * T ) ); // SunAppLong
+    double tY = SolarTan( SolarRadians( Oc / 2.0 ) );
+    double Y  = tY * tY;                                                                         // VarY
+    SunDeclin = SolarDegrees( SolarAsin( SolarSin( SolarRadians( Oc ) ) * SolarSin( SolarRadians( A ) ) ) );
+    EqOfTime  = 4.0 * SolarDegrees( Y * SolarSin( 2.0 * SolarRadians( L ) ) - 2.0 * E * SolarSin( SolarRadians( M ) ) + 4.0 * E * Y * SolarSin( SolarRadians( M ) ) * SolarCos( 2.0 * SolarRadians( L ) ) - 0.5 * Y * Y * SolarSin( 4.0 * SolarRadians( L ) ) - 1.25 * E * E * SolarSin( 2.0 * SolarRadians( M ) ) );
+}
+//--------------------------------------------------------------------------------------------------
+inline double SolarRefraction( double SolarElevationAngle ) { // ApproxAtmosphericRefraction, degrees
+    if( SolarElevationAngle > 85.0 ) {
+        return 0;
+    } else if( SolarElevationAngle > 5.0 ) {
+        double dTemp = SolarTan( SolarRadians( SolarElevationAngle ) );
+        return ( 58.1 / dTemp - 0.07 / pow( dTemp, 3 ) + 0.000086 / pow( dTemp, 5.0 ) ) / 3600.0;
+    } else if( SolarElevationAngle > -0.575 ) {
+        return ( 1735.0 + SolarElevationAngle * ( -518.2 + SolarElevationAngle * ( 103.4 + SolarElevationAngle * ( -12.79 + SolarElevationAngle * 0.711 ) ) ) ) / 3600.0;
+    } else {
+        return ( -20.772 / SolarTan( SolarRadians( SolarElevationAngle ) ) ) / 3600.0;
+    }
+}
+//--------------------------------------------------------------------------------------------------
+inline double SolarGeometricElevation( double SolarElevationAngle ) {
+    // Inverse of elevation + SolarRefraction( elevation ): the geometric elevation at which the sun shows at
+    // SolarElevationAngle. Bisection, refraction is 0 .. 0.58 degree and elevation + refraction never decreases.
+    double Low = SolarElevationAngle - 1.0, High = SolarElevationAngle;
+    for( int i = 0; i < 40; i++ ) {
+        double Mid = 0.5 * ( Low + High );
+        if( Mid + SolarRefraction( Mid ) < SolarElevationAngle ) {
+            Low = Mid;
+        } else {
+            High = Mid;
+        }
+    }
+    return 0.5 * ( Low + High );
+}
+//--------------------------------------------------------------------------------------------------
+inline void SolarHorizon( const SolarSite& Site, int32_t Seconds, SolarPosition& Position ) {
+    // Hour angle, zenith, refraction and elevation from the declination and equation of time in Position, no azimuth
+    double TST = fmod( Seconds / 86400.0 * 1440.0 + Position.EqOfTime + 4.0 * Site.Longitude - 60.0 * Site.TimeZone, 1440.0 );
+    Position.HourAngle = ( TST / 4.0 < 0 ) ? TST / 4.0 + 180.0 : TST / 4.0 - 180.0;
+    Position.SolarZenithAngle = SolarDegrees( SolarAcos( Site.SinLatitude * SolarSin( SolarRadians( Position.SunDeclin ) ) + Site.CosLatitude * SolarCos( SolarRadians( Position.SunDeclin ) ) * SolarCos( SolarRadians( Position.HourAngle ) ) ) );
+    Position.ApproxAtmosphericRefraction = SolarRefraction( 90.0 - Position.SolarZenithAngle );
+    Position.SolarElevation = 90.0 - Position.SolarZenithAngle + Position.ApproxAtmosphericRefraction;
+}
+//--------------------------------------------------------------------------------------------------
+inline double SolarAzimuth( const SolarSite& Site, const SolarPosition& Position ) {
+    double dTemp = SolarDegrees( SolarAcos( ( ( Site.SinLatitude * SolarCos( SolarRadians( Position.SolarZenithAngle ) ) ) - SolarSin( SolarRadians( Position.SunDeclin ) ) ) / ( Site.CosLatitude * SolarSin( SolarRadians( Position.SolarZenithAngle ) ) ) ) );
+    if( Position.HourAngle > 0.0 ) {
+        return fmod( dTemp + 180.0, 360.0 );
+    } else {
+        return fmod( 540.0 - dTemp, 360.0 );
+    }
+}
+//--------------------------------------------------------------------------------------------------
+inline void SolarEphemerisAt( const SolarSite& Site, int32_t DayNumber, int32_t Seconds, const SolarEphemerisTable* Table, SolarPosition& Position ) {
+    // Julian century, declination and equation of time, from Table when it covers the instant
+    double JD = SolarJulianDay( Site, DayNumber, Seconds );
+    Position.JulianCentury = ( JD - 2451545.0 ) / 36525.0;
+    if( !Table || !Table->Lookup( JD, Position.SunDeclin, Position.EqOfTime ) ) {
+        SolarSunEphemeris( Position.JulianCentury, Position.SunDeclin, Position.EqOfTime );
+    }
+}
+//--------------------------------------------------------------------------------------------------
+inline SunEvents SolarEventsFor( const SolarSite& Site, double SunDeclin, double EqOfTime ) {
+    SunEvents Events;
+    Events.SunriseDegrees = SolarDegrees( SolarAcos( SolarCos( SolarRadians( 90.833 ) ) / ( Site.CosLatitude * SolarCos( SolarRadians( SunDeclin ) ) ) - Site.TanLatitude * SolarTan( SolarRadians( SunDeclin ) ) ) );
+    Events.SolarNoon   = ( 720.0 - 4.0 * Site.Longitude - EqOfTime + Site.TimeZone * 60.0 ) / 1440.0;
+    Events.SunriseTime = Events.SolarNoon - Events.SunriseDegrees * 4.0 / 1440.0;
+    Events.SunsetTime  = Events.SolarNoon + Events.SunriseDegrees * 4.0 / 1440.0;
+    return Events;
+}
+//--------------------------------------------------------------------------------------------------
+inline SolarPosition SolarPositionAt( const SolarSite& Site, int32_t DayNumber, int32_t Seconds, const SolarEphemerisTable* Table = 0 ) {
+    SolarPosition Position;
+    SolarEphemerisAt( Site, DayNumber, Seconds, Table, Position );
+    SolarHorizon( Site, Seconds, Position );
+    Position.SolarAzimuthAngle = SolarAzimuth( Site, Position );
+    return Position;
+}
+//--------------------------------------------------------------------------------------------------
+inline SolarPosition SolarPositionUnix( const SolarSite& Site, int64_t UnixTime, const SolarEphemerisTable* Table = 0 ) {
+    int32_t DayNumber, Seconds;
+    SolarLocalTime( Site, UnixTime, DayNumber, Seconds );
+    return SolarPositionAt( Site, DayNumber, Seconds, Table );
+}
+//--------------------------------------------------------------------------------------------------
+inline SunEvents SolarEventsAt( const SolarSite& Site, int32_t DayNumber, const SolarEphemerisTable* Table = 0 ) {
+    // Sunrise, noon and sunset of the local day, with the declination and equation of time taken at 12:00 of that day
+    SolarPosition Position;
+    SolarEphemerisAt( Site, DayNumber, 43200, Table, Position );
+    return SolarEventsFor( Site, Position.SunDeclin, Position.EqOfTime );
+}
+//--------------------------------------------------------------------------------------------------
+inline SunEvents SolarEventsUnix( const SolarSite& Site, int64_t UnixTime, const SolarEphemerisTable* Table = 0 ) {
+    // Events of the local day UnixTime falls on, the same for every instant of that day
+    int32_t DayNumber, Seconds;
+    SolarLocalTime( Site, UnixTime, DayNumber, Seconds );
+    return SolarEventsAt( Site, DayNumber, Table );
+}
+//--------------------------------------------------------------------------------------------------
+
+#endif // SOLARCORE_H
@@ -0,0 +1,82 @@
+#ifndef SOLAREPHEMERIS_H
+#define SOLAREPHEMERIS_H
+
+#include "Solar.h"
+
+//--------------------------------------------------------------------------------------------------
+template <typename T>
+class SolarEphemeris : public SolarEphemerisTable {
+    // Table of SunDeclin() and EqOfTime() at 0:00 UTC every StepDays days from January 1st of FirstYear up to and
+    // including December 31st of LastYear, filled once from the full NOAA chain by the constructor.
+    // Lookup() interpolates with a cubic through the four nearest nodes, so Solar::setEphemeris() can skip the
+    // GeomMeanLongSun / SunEqOfCtr / ObliqCorr trig chain for every date inside the table.
+    //
+    // Memory is 2 * sizeof(T) bytes per node, nodes = days / StepDays + 4. Accuracy against the full chain, checked
+    // by "solar_example ephemeris" (ctest):
+    //   SolarEphemeris<double>( 1901, 2099, 1 )   1.16 MB   declination 1.5e-7 deg, equation of time 5e-7 min
+    //   SolarEphemeris<float> ( 1901, 2099, 1 )    582 kB   declination 1.5e-6 deg, equation of time 2e-6 min
+    //   SolarEphemeris<float> ( 2020, 2039, 4 )     15 kB   declination 3e-5 deg,   equation of time 1.5e-4 min
+    //   SolarEphemeris<float> ( 2025, 2034, 8 )    3.7 kB   declination 5e-4 deg,   equation of time 2e-3 min
+    // The first two are server sized, the last two fit a micro controller (ESP32, STM32, not an Uno with 2 kB RAM).
+    // Buffer may point to caller storage of Nodes( FirstYear, LastYear, StepDays ) * 2 elements, otherwise it is new[]ed.
+public:
+    SolarEphemeris( int FirstYear, int LastYear, int StepDays, T* Buffer = 0 ) {
+        Solar Sun( 0.0, 0.0, 0.0 );
+        m_Step  = StepDays;
+        m_Nodes = Nodes( FirstYear, LastYear, StepDays );
+        m_First = DayNumber( FirstYear ) - StepDays;                // one node before the first day for the cubic
+        m_Last  = DayNumber( LastYear + 1 );
+        m_Owner = ( Buffer == 0 );
+        m_Data  = m_Owner ? new T[2 * m_Nodes] : Buffer;
+        for( long i = 0; i < m_Nodes; i++ ) {
+            double Declin, EqOfTime;
+            Sun.SunEphemeris( m_First + i * StepDays, Declin, EqOfTime );
+            m_Data[2 * i]     = ( T ) Declin;
+            m_Data[2 * i + 1] = ( T ) EqOfTime;
+        }
+    }
+    ~SolarEphemeris( void ) {
+        if( m_Owner ) {
+            delete[] m_Data;
+        }
+    }
+    static long Nodes( int FirstYear, int LastYear, int StepDays ) {
+        return ( DayNumber( LastYear + 1 ) - DayNumber( FirstYear ) ) / StepDays + 4;
+    }
+    long Bytes( void ) const {
+        return m_Nodes * 2 * ( long ) sizeof( T );
+    }
+    bool Lookup( double JulianDay, double& SunDeclin, double& EqOfTime ) const {
+        if( JulianDay < m_First + m_Step || JulianDay >= m_Last ) {
+            return false;
+        }
+        double x = ( JulianDay - m_First ) / m_Step;
+        long i = ( long ) x;                                        // node left of JulianDay, 1 <= i <= m_Nodes - 3
+        double f = x - i;
+        // Lagrange weights of the nodes i-1, i, i+1, i+2
+        double w0 = -f * ( f - 1.0 ) * ( f - 2.0 ) / 6.0;
+        double w1 = ( f + 1.0 ) * ( f - 1.0 ) * ( f - 2.0 ) / 2.0;
+        double w2 = -( f + 1.0 ) * f * ( f - 2.0 ) / 2.0;
+        double w3 = ( f + 1.0 ) * f * ( f - 1.0 ) / 6.0;
+        const T* p = m_Data + 2 * ( i - 1 );
+        SunDeclin = w0 * p[0] + w1 * p[2] + w2 * p[4] + w3 * p[6];
+        EqOfTime  = w0 * p[1] + w1 * p[3] + w2 * p[5] + w3 * p[7];
+        return true;
+    }
+private:
+    SolarEphemeris( const SolarEphemeris& );
+    SolarEphemeris& operator=( const SolarEphemeris& );
+    static double DayNumber( int Year ) { // Julian day of January 1st, 0:00 UTC
+        long y = Year - 1;
+        return 1721425.5 + 365L * y + y / 4 - y / 100 + y / 400;
+    }
+    T* m_Data;
+    bool m_Owner;
+    long m_Nodes;
+    int m_Step;
+    double m_First;
+    double m_Last;
+};
+//--------------------------------------------------------------------------------------------------
+
+#endif // SOLAREPHEMERIS_H
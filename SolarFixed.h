@@ -0,0 +1,304 @@
+#ifndef SOLARFIXED_H
+#define SOLARFIXED_H
+
+#include "Solar.h"
+#include "SolarMath.h"
+
+//--------------------------------------------------------------------------------------------------
+struct SolarConstexpr {
+    // sin/cos/tan usable in constant expressions (C++11), good to 1e-15 for |x| <= pi / 2 + 0.1
+    static constexpr double Pi = 3.141592654; // the same rounded value as SolarRadians()
+    static constexpr double Radians( double Degrees ) {
+        return Degrees * Pi / 180.0;
+    }
+    static constexpr double SinSeries( double x2, double Term, int n ) {
+        return ( n > 24 ) ? 0.0 : Term + SinSeries( x2, -Term * x2 / ( ( 2.0 * n ) * ( 2.0 * n + 1.0 ) ), n + 1 );
+    }
+    static constexpr double CosSeries( double x2, double Term, int n ) {
+        return ( n > 24 ) ? 0.0 : Term + CosSeries( x2, -Term * x2 / ( ( 2.0 * n - 1.0 ) * ( 2.0 * n ) ), n + 1 );
+    }
+    static constexpr double Sin( double x ) {
+        return SinSeries( x * x, x, 1 );
+    }
+    static constexpr double Cos( double x ) {
+        return CosSeries( x * x, 1.0, 1 );
+    }
+    static constexpr double Tan( double x ) {
+        return Sin( x ) / Cos( x );
+    }
+};
+//--------------------------------------------------------------------------------------------------
+template <class Site, typename T = double, class Math = SolarLibm<T> >
+class SolarFixed {
+    // Solar for an installation whose coordinates never change, with the same public interface as Solar
+    // Site is a struct with static constexpr double TimeZone, Latitude and Longitude, for example:
+    //     struct Zevenaar { static constexpr double TimeZone = 0.4038, Latitude = 51.9291, Longitude = 6.0565; };
+    //     SolarFixed<Zevenaar, float> m_Solar;
+    // Sine, cosine and tangent of the latitude, the cosine of the 90.833 degree sunrise zenith and all unit conversion
+    // factors are folded at compile time. T selects the precision of the NOAA chain, time goes in as integers.
+    // Math supplies the trig: SolarLibm<T> (default) or SolarFastMath polynomials for T = float, see SolarMath.h.
+    // SolarFixed<Site, double> stays within 1e-5 degree and 10 ms of Solar ("solar_bench --check"), float within 0.01
+    // degree and 1 s ("solar_example precision").
+    // The date/time is kept like in Solar, as a local day number and seconds past midnight with the UTC offset in whole
+    // seconds folded at compile time, so DateCalc(), setUnixTime() etc. behave exactly the same without a Solar object.
+    // SunEphemeris(), SolarPositions() and ElevationCrossings...() need the double chain of Solar, they build one for
+    // the call (Helper()), a table set with setEphemeris() is handed on to it.
+public:
+    SolarFixed( void ) : m_DayNumber( 10957 ), m_Seconds( 0 ), m_StateValid( false ), m_Ephemeris( 0 ), m_Day( INT64_MIN ) {} // 2000-01-01 00:00
+    void setDateTime( int Year, uint8_t Month, uint8_t Day, uint8_t Hour, uint8_t Minute, uint8_t Second = 0 ) {
+        setDate( Year, Month, Day );
+        setTime( Hour, Minute, Second );
+    }
+    void setDate( int Year, uint8_t Month, uint8_t Day ) {
+        m_DayNumber  = SolarDaysFromCivil( Year, Month, Day );
+        m_StateValid = false;
+    }
+    void setTime( uint8_t Hour, uint8_t Minute, uint8_t Second = 0 ) {
+        m_Seconds    = ( int32_t ) Hour * 3600L + Minute * 60L + Second;
+        m_StateValid = false;
+    }
+    void setUnixTime( int64_t UnixTime ) {
+        SolarLocalTime( UnixOffset, UnixTime, m_DayNumber, m_Seconds );
+        m_StateValid = false;
+    }
+    int64_t getUnixTime( void ) {
+        return ( int64_t ) m_DayNumber * 86400 + m_Seconds - UnixOffset;
+    }
+    void DateCalc( char part, int offset ) {
+        SolarDateCalc( m_DayNumber, m_Seconds, part, offset );
+        m_StateValid = false;
+    }
+    int GetYear( void ) {
+        int Year;
+        uint8_t Month, Day;
+        SolarCivilFromDays( m_DayNumber, Year, Month, Day );
+        return Year;
+    }
+    uint8_t GetMonth( void ) {
+        int Year;
+        uint8_t Month, Day;
+        SolarCivilFromDays( m_DayNumber, Year, Month, Day );
+        return Month;
+    }
+    uint8_t GetDay( void ) {
+        int Year;
+        uint8_t Month, Day;
+        SolarCivilFromDays( m_DayNumber, Year, Month, Day );
+        return Day;
+    }
+    uint8_t GetHours( void ) {
+        return m_Seconds / 3600;
+    }
+    uint8_t GetMinutes( void ) {
+        return ( m_Seconds / 60 ) % 60;
+    }
+    uint8_t GetSeconds( void ) {
+        return m_Seconds % 60;
+    }
+    bool LeapYear( void ) {
+        int Year = GetYear();
+        return ( Year % 4 == 0 ) && ( Year % 100 != 0 || Year % 400 == 0 );
+    }
+    T SolarElevation( void ) { // Corrected for atm. refraction
+        Update();
+        return T( 90 ) - m_Zenith + m_Refraction;
+    }
+    T SolarAzimuthAngle( void ) {
+        Update();
+        T a = Deg * Math::Atan2( m_East, m_North ); // clockwise from north
+        return ( a < T( 0 ) ) ? a + T( 360 ) : a;
+    }
+    T SunriseDegrees( void ) {
+        UpdateDay();
+        return m_SunriseDegrees;
+    }
+    T SunsetDegrees( void ) {
+        return T( 360 ) - SunriseDegrees();
+    }
+    T SolarNoon( void ) {
+        UpdateDay();
+        return m_SolarNoon;
+    }
+    T SunriseTime( void ) {
+        return SolarNoon() - SunriseDegrees() / T( 360 );
+    }
+    T SunsetTime( void ) {
+        return SolarNoon() + SunriseDegrees() / T( 360 );
+    }
+    T SunDeclination( void ) {
+        Update();
+        return m_SunDeclin;
+    }
+    T EquationOfTime( void ) {
+        Update();
+        return m_EqOfTime;
+    }
+    bool DayTime( void ) {
+        T Time = DecimalTime();
+        return Time >= SunriseTime() && Time <= SunsetTime();
+    }
+    T MinutesToSunrise( void ) {
+        return Countdown( T( -1 ) );
+    }
+    T MinutesToSunset( void ) {
+        return Countdown( T( 1 ) );
+    }
+    void SunEphemeris( double JulianDay, double& SunDeclin, double& EqOfTime ) {
+        Helper().SunEphemeris( JulianDay, SunDeclin, EqOfTime );
+    }
+    void setEphemeris( const SolarEphemerisTable* Table ) {
+        m_Ephemeris  = Table;
+        m_StateValid = false;
+        m_Day        = INT64_MIN;
+    }
+    bool ElevationCrossings( double Elevation, double& Rise, double& Set, bool Refracted = false ) {
+        return Helper().ElevationCrossings( Elevation, Rise, Set, Refracted );
+    }
+    int ElevationCrossingsYear( int Year, double Elevation, double* Rise, double* Set, bool Refracted = false ) {
+        return Helper().ElevationCrossingsYear( Year, Elevation, Rise, Set, Refracted );
+    }
+    void SolarPositions( const SolarInstants& Instants, int Count, double* Elevation, double* Azimuth, double* Zenith, double* Declination ) {
+        Helper().SolarPositions( Instants, Count, Elevation, Azimuth, Zenith, Declination );
+    }
+private:
+    static constexpr T Rad    = T( SolarConstexpr::Pi / 180.0 );
+    static constexpr T Deg    = T( 180.0 / SolarConstexpr::Pi );
+    static constexpr T SinLat = T( SolarConstexpr::Sin( SolarConstexpr::Radians( Site::Latitude ) ) );
+    static constexpr T CosLat = T( SolarConstexpr::Cos( SolarConstexpr::Radians( Site::Latitude ) ) );
+    static constexpr T TanLat = T( SolarConstexpr::Tan( SolarConstexpr::Radians( Site::Latitude ) ) );
+    static constexpr T CosSunrise = T( SolarConstexpr::Cos( SolarConstexpr::Radians( 90.833 ) ) );
+    static constexpr T SolarOffset = T( 4.0 * Site::Longitude - 60.0 * Site::TimeZone ); // minutes, TrueSolarTime()
+    static constexpr int32_t Floor( double x ) {
+        return int32_t( x ) - ( x < int32_t( x ) ? 1 : 0 );
+    }
+    static constexpr int32_t UnixOffset = Floor( Site::TimeZone * 3600.0 + 0.5 ); // SolarUnixOffset() at compile time
+    Solar Helper( void ) { // Solar at the same date/time and table, only built for the double only functions
+        Solar Sun( Site::TimeZone, Site::Latitude, Site::Longitude );
+        Sun.setUnixTime( getUnixTime() );
+        Sun.setEphemeris( m_Ephemeris );
+        return Sun;
+    }
+    T DecimalTime( void ) {
+        return T( m_Seconds ) / T( 86400 );
+    }
+    // Time is handed to the chain as whole days and seconds since J2000.0 (2000-01-01 12:00 UTC). The two fast angles
+    // (mean longitude and anomaly, about a degree a day) are reduced modulo 360 degrees in integers of 1e-11 degree,
+    // in float the product rate x days would carry 1e-3 degree of rounding. The slow terms use the Julian century as a
+    // float. With T = float no double arithmetic is left, only the rates below are computed by the compiler.
+    static constexpr int64_t Turn = 36000000000000LL;   // 360 degrees in 1e-11 degree
+    static constexpr int64_t MeanLongSun  = int64_t( 280.46646 * 1e11 + 0.5 );
+    static constexpr int64_t MeanLongRate = int64_t( 36000.76983 / 36525.0 * 1e11 + 0.5 );  // per day
+    static constexpr int64_t MeanAnomSun  = int64_t( 357.52911 * 1e11 + 0.5 );
+    static constexpr int64_t MeanAnomRate = int64_t( 35999.05029 / 36525.0 * 1e11 + 0.5 );
+    static T Angle( int64_t Start, int64_t Rate, int32_t Days, int32_t Seconds ) { // Start + Rate * time, 0 .. 360
+        int64_t a = ( Start + Rate * Days + Rate * Seconds / 86400 ) % Turn;
+        a = ( a < 0 ) ? a + Turn : a;
+        return T( a / 100000000000LL ) + T( a % 100000000000LL ) * T( 1e-11 );
+    }
+    void Ephemeris( int64_t UnixTime, T& SinDeclin, T& EqOfTime ) { // SolarSunEphemeris() in precision T, or the table
+        int64_t J2000 = UnixTime - 946728000LL;
+        int32_t Days  = ( int32_t )( J2000 / 86400 ) - ( J2000 % 86400 < 0 ? 1 : 0 );
+        int32_t Seconds = ( int32_t )( J2000 - ( int64_t ) Days * 86400 );
+        double Declin, EoT;
+        if( m_Ephemeris && m_Ephemeris->Lookup( 2451545.0 + Days + Seconds / 86400.0, Declin, EoT ) ) { // the table takes a double Julian day
+            SinDeclin = Math::Sin( T( Declin ) * Rad );
+            EqOfTime  = T( EoT );
+            return;
+        }
+        T JC = ( T( Days ) + T( Seconds ) / T( 86400 ) ) / T( 36525 );
+        T L  = Angle( MeanLongSun, MeanLongRate, Days, Seconds ) + T( 0.0003032 ) * JC * JC;
+        T M  = Angle( MeanAnomSun, MeanAnomRate, Days, Seconds ) - T( 0.0001537 ) * JC * JC;
+        T E  = T( 0.016708634 ) - JC * ( T( 0.000042037 ) + T( 0.0000001267 ) * JC );
+        T Om = ( T( 125.04 ) - T( 1934.136 ) * JC ) * Rad;
+        T OC = T( 23 ) + ( T( 26 ) + ( T( 21.448 ) - JC * ( T( 46.815 ) + JC * ( T( 0.00059 ) - JC * T( 0.001813 ) ) ) ) / T( 60 ) ) / T( 60 ) + T( 0.00256 ) * Math::Cos( Om );
+        T C  = Math::Sin( M * Rad ) * ( T( 1.914602 ) - JC * ( T( 0.004817 ) + T( 0.000014 ) * JC ) ) + Math::Sin( T( 2 ) * M * Rad ) * ( T( 0.019993 ) - T( 0.000101 ) * JC ) + Math::Sin( T( 3 ) * M * Rad ) * T( 0.000289 );
+        T A  = L + C - T( 0.00569 ) - T( 0.00478 ) * Math::Sin( Om );
+        T tY = Math::Tan( OC / T( 2 ) * Rad );
+        T Y  = tY * tY;
+        SinDeclin = Math::Sin( OC * Rad ) * Math::Sin( A * Rad );
+        EqOfTime  = T( 4 ) * Deg * ( Y * Math::Sin( T( 2 ) * L * Rad ) - T( 2 ) * E * Math::Sin( M * Rad ) + T( 4 ) * E * Y * Math::Sin( M * Rad ) * Math::Cos( T( 2 ) * L * Rad ) - T( 0.5 ) * Y * Y * Math::Sin( T( 4 ) * L * Rad ) - T( 1.25 ) * E * E * Math::Sin( T( 2 ) * M * Rad ) );
+    }
+    void Update( void ) { // the NOAA chain of Solar::UpdateState() in precision T
+        if( m_StateValid ) {
+            return;
+        }
+        Ephemeris( getUnixTime(), m_SinDeclin, m_EqOfTime );
+        m_SunDeclin = Deg * Math::Asin( m_SinDeclin );
+        m_CosDeclin = Math::Sqrt( T( 1 ) - m_SinDeclin * m_SinDeclin );
+        T TST = fmod( DecimalTime() * T( 1440 ) + m_EqOfTime + SolarOffset, T( 1440 ) );
+        m_HourAngle = ( TST < T( 0 ) ) ? TST / T( 4 ) + T( 180 ) : TST / T( 4 ) - T( 180 );
+        // Sun vector (east, north, up) instead of the acos() of the NOAA sheet: acos() near 1 and the azimuth acos()
+        // around noon lose up to 0.02 degree in float. Zenith and azimuth follow from atan2(), same values in double.
+        T H = m_HourAngle * Rad;
+        m_East      = -m_CosDeclin * Math::Sin( H );
+        m_North     = CosLat * m_SinDeclin - SinLat * m_CosDeclin * Math::Cos( H );
+        m_CosZenith = SinLat * m_SinDeclin + CosLat * m_CosDeclin * Math::Cos( H );
+        m_SinZenith = Math::Sqrt( m_East * m_East + m_North * m_North );
+        m_Zenith    = Deg * Math::Atan2( m_SinZenith, m_CosZenith );
+        T e = T( 90 ) - m_Zenith;
+        T t = m_CosZenith / m_SinZenith; // Math::Tan( e )
+        if( e > T( 85 ) ) {
+            m_Refraction = T( 0 );
+        } else if( e > T( 5 ) ) {
+            m_Refraction = ( T( 58.1 ) / t - T( 0.07 ) / ( t * t * t ) + T( 0.000086 ) / ( t * t * t * t * t ) ) / T( 3600 );
+        } else if( e > T( -0.575 ) ) {
+            m_Refraction = ( T( 1735 ) + e * ( T( -518.2 ) + e * ( T( 103.4 ) + e * ( T( -12.79 ) + e * T( 0.711 ) ) ) ) ) / T( 3600 );
+        } else {
+            m_Refraction = ( T( -20.772 ) / t ) / T( 3600 );
+        }
+        m_StateValid = true;
+    }
+    void UpdateDay( void ) { // sunrise hour angle and noon of the day at 12:00 local, like Solar::Events()
+        int64_t Day = ( int64_t ) m_DayNumber * 86400 + 43200 - UnixOffset;
+        if( Day == m_Day ) {
+            return;
+        }
+        DayEvents( Day, m_SunriseDegrees, m_SolarNoon );
+        m_Day = Day;
+    }
+    void DayEvents( int64_t Day, T& SunriseDegrees, T& SolarNoon ) { // of the day whose 12:00 local is Day (UTC)
+        T SinDeclin, EqOfTime;
+        Ephemeris( Day, SinDeclin, EqOfTime );
+        T CosDeclin = Math::Sqrt( T( 1 ) - SinDeclin * SinDeclin );
+        SunriseDegrees = Deg * Math::Acos( CosSunrise / ( CosLat * CosDeclin ) - TanLat * SinDeclin / CosDeclin );
+        SolarNoon = ( T( 720.0 - 4.0 * Site::Longitude + Site::TimeZone * 60.0 ) - EqOfTime ) / T( 1440 );
+    }
+    T Countdown( T Direction ) { // minutes to the next sunrise (-1) or sunset (+1) like Solar::MinutesToSunrise()
+        UpdateDay();
+        T Time  = DecimalTime();
+        T Event = m_SolarNoon + Direction * m_SunriseDegrees / T( 360 );
+        if( Time <= Event ) {
+            return ( Event - Time ) * T( 1440 );
+        }
+        for( int Day = 1; Day <= 366; Day++ ) { // NAN today means polar night or day, look further ahead
+            T Degrees, Noon;
+            DayEvents( m_Day + Day * 86400LL, Degrees, Noon );
+            Event = Noon + Direction * Degrees / T( 360 );
+            if( !isnan( Event ) ) {
+                return ( Event + T( Day ) - Time ) * T( 1440 );
+            }
+        }
+        return T( NAN );
+    }
+    int32_t m_DayNumber;    // local (solar) date as days since 1970-01-01
+    int32_t m_Seconds;      // local (solar) time as seconds past midnight, 0 .. 86399
+    bool m_StateValid;
+    const SolarEphemerisTable* m_Ephemeris;
+    T m_SunDeclin;
+    T m_SinDeclin;
+    T m_CosDeclin;
+    T m_EqOfTime;
+    T m_HourAngle;
+    T m_Zenith;
+    T m_East;
+    T m_North;
+    T m_CosZenith;
+    T m_SinZenith;
+    T m_Refraction;
+    int64_t m_Day;          // UTC of 12:00 local of the day below
+    T m_SunriseDegrees;
+    T m_SolarNoon;
+};
+//--------------------------------------------------------------------------------------------------
+
+#endif // SOLARFIXED_H
@@ -0,0 +1,38 @@
+#ifndef SOLARFLEET_H
+#define SOLARFLEET_H
+
+#include "Solar.h"
+
+//--------------------------------------------------------------------------------------------------
+class SolarFleet {
+    // Sun position for many sites at one instant
+    // The date dependent part of the NOAA chain (Julian century, declination, equation of time) is computed once per
+    // instant by setDateTime(), Evaluate() then only does the hour angle, zenith and azimuth of each site.
+    // Site coordinates are kept in contiguous arrays together with the sine and cosine of their latitude.
+public:
+    SolarFleet( int Capacity );
+    ~SolarFleet( void );
+    int AddSite( double Latitude, double Longitude );
+    int Sites( void );
+    void setDateTime( int Year, uint8_t Month, uint8_t Day, uint8_t Hour, uint8_t Minute );
+    void Evaluate( double* Elevation, double* Azimuth, int First, int Count );
+    void Evaluate( double* Elevation, double* Azimuth );
+#ifndef ARDUINO
+    void EvaluateParallel( double* Elevation, double* Azimuth, int Threads );
+#endif
+private:
+    SolarFleet( const SolarFleet& );
+    SolarFleet& operator=( const SolarFleet& );
+    Solar m_Sun;
+    int m_Capacity;
+    int m_Sites;
+    double* m_SinLatitude;
+    double* m_CosLatitude;
+    double* m_Longitude;
+    double m_SinDeclin;
+    double m_CosDeclin;
+    double m_Minutes;   // UTC minutes past midnight plus the equation of time
+};
+//--------------------------------------------------------------------------------------------------
+
+#endif // SOLARFLEET_H
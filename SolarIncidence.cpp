@@ -0,0 +1,116 @@
+#include "SolarIncidence.h"
+
+// Angles are in degrees like in Solar: tilt from horizontal, azimuth clockwise from north. A tracker rotates about its
+// axis, a positive rotation tilts the panel towards AxisAzimuth + 90 (east for an axis pointing north), 0 is flat.
+// Tracker rotation follows Marion and Dobos (NREL/TP-6A20-58891) with backtracking for rows on level ground.
+
+//--------------------------------------------------------------------------------------------------
+SolarIncidence::SolarIncidence( int Capacity ) {
+    m_Capacity       = Capacity;
+    m_Panels         = 0;
+    m_Trackers       = 0;
+    m_East           = new double[Capacity];
+    m_North          = new double[Capacity];
+    m_Up             = new double[Capacity];
+    m_SinAxisTilt    = new double[Capacity];
+    m_CosAxisTilt    = new double[Capacity];
+    m_SinAxisAzimuth = new double[Capacity];
+    m_CosAxisAzimuth = new double[Capacity];
+    m_MaxRotation    = new double[Capacity];
+    m_GroundCoverage = new double[Capacity];
+    m_SunEast        = 0.0;
+    m_SunNorth       = 0.0;
+    m_SunUp          = 1.0;
+}
+//--------------------------------------------------------------------------------------------------
+SolarIncidence::~SolarIncidence( void ) {
+    delete[] m_East;
+    delete[] m_North;
+    delete[] m_Up;
+    delete[] m_SinAxisTilt;
+    delete[] m_CosAxisTilt;
+    delete[] m_SinAxisAzimuth;
+    delete[] m_CosAxisAzimuth;
+    delete[] m_MaxRotation;
+    delete[] m_GroundCoverage;
+}
+//--------------------------------------------------------------------------------------------------
+int SolarIncidence::AddPanel( double Tilt, double Azimuth ) { // returns the index of the panel, -1 when full
+    if( m_Panels >= m_Capacity ) {
+        return -1;
+    }
+    const double Rad = 3.141592654 / 180.0;
+    m_East[m_Panels]  = sin( Tilt * Rad ) * sin( Azimuth * Rad );
+    m_North[m_Panels] = sin( Tilt * Rad ) * cos( Azimuth * Rad );
+    m_Up[m_Panels]    = cos( Tilt * Rad );
+    return m_Panels++;
+}
+//--------------------------------------------------------------------------------------------------
+int SolarIncidence::AddTracker( double AxisTilt, double AxisAzimuth, double MaxRotation, double GroundCoverage ) {
+    // Returns the index of the tracker, -1 when full. GroundCoverage is the panel width divided by the row pitch,
+    // 0 switches backtracking off.
+    if( m_Trackers >= m_Capacity ) {
+        return -1;
+    }
+    const double Rad = 3.141592654 / 180.0;
+    m_SinAxisTilt[m_Trackers]    = sin( AxisTilt * Rad );
+    m_CosAxisTilt[m_Trackers]    = cos( AxisTilt * Rad );
+    m_SinAxisAzimuth[m_Trackers] = sin( AxisAzimuth * Rad );
+    m_CosAxisAzimuth[m_Trackers] = cos( AxisAzimuth * Rad );
+    m_MaxRotation[m_Trackers]    = MaxRotation;
+    m_GroundCoverage[m_Trackers] = GroundCoverage;
+    return m_Trackers++;
+}
+//--------------------------------------------------------------------------------------------------
+int SolarIncidence::Panels( void ) {
+    return m_Panels;
+}
+//--------------------------------------------------------------------------------------------------
+int SolarIncidence::Trackers( void ) {
+    return m_Trackers;
+}
+//--------------------------------------------------------------------------------------------------
+void SolarIncidence::setSun( double Elevation, double Azimuth ) { // as returned by SolarElevation() and SolarAzimuthAngle()
+    const double Rad = 3.141592654 / 180.0;
+    m_SunEast  = cos( Elevation * Rad ) * sin( Azimuth * Rad );
+    m_SunNorth = cos( Elevation * Rad ) * cos( Azimuth * Rad );
+    m_SunUp    = sin( Elevation * Rad );
+}
+//--------------------------------------------------------------------------------------------------
+void SolarIncidence::setSun( Solar& Sun ) {
+    setSun( Sun.SolarElevation(), Sun.SolarAzimuthAngle() );
+}
+//--------------------------------------------------------------------------------------------------
+void SolarIncidence::EvaluatePanels( double* CosIncidence ) {
+    // Fills CosIncidence[0 .. Panels()-1], negative when the sun is behind the panel
+    const double E = m_SunEast;
+    const double N = m_SunNorth;
+    const double U = m_SunUp;
+    for( int i = 0; i < m_Panels; i++ ) {
+        CosIncidence[i] = m_East[i] * E + m_North[i] * N + m_Up[i] * U;
+    }
+}
+//--------------------------------------------------------------------------------------------------
+void SolarIncidence::EvaluateTrackers( double* Rotation, double* CosIncidence ) {
+    // Fills Rotation[0 .. Trackers()-1] in degrees and CosIncidence[0 .. Trackers()-1]
+    // With the sun below the horizon the trackers are stowed flat (rotation 0).
+    const double Deg = 180.0 / 3.141592654;
+    const double E = m_SunEast;
+    const double N = m_SunNorth;
+    const double U = m_SunUp;
+    for( int i = 0; i < m_Trackers; i++ ) {
+        // sun in the tracker frame: x across the axis, z normal to the flat panel
+        double x = E * m_CosAxisAzimuth[i] - N * m_SinAxisAzimuth[i];
+        double z = ( E * m_SinAxisAzimuth[i] + N * m_CosAxisAzimuth[i] ) * m_SinAxisTilt[i] + U * m_CosAxisTilt[i];
+        double r = Deg * atan2( x, z );
+        double c = fabs( z ) / ( sqrt( x * x + z * z ) * m_GroundCoverage[i] ); // cos( r ) / GroundCoverage
+        if( m_GroundCoverage[i] > 0.0 && c < 1.0 ) { // rows shade each other, turn back towards flat
+            r -= ( r > 0.0 ? Deg : -Deg ) * acos( c );
+        }
+        r = ( r > m_MaxRotation[i] ) ? m_MaxRotation[i] : ( r < -m_MaxRotation[i] ) ? -m_MaxRotation[i] : r;
+        r = ( U > 0.0 ) ? r : 0.0;
+        Rotation[i]     = r;
+        CosIncidence[i] = x * sin( r / Deg ) + z * cos( r / Deg );
+    }
+}
+//--------------------------------------------------------------------------------------------------
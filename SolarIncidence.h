@@ -0,0 +1,44 @@
+#ifndef SOLARINCIDENCE_H
+#define SOLARINCIDENCE_H
+
+#include "Solar.h"
+
+//--------------------------------------------------------------------------------------------------
+class SolarIncidence {
+    // Cosine of the angle of incidence for many panel orientations at one sun position
+    // Fixed panels (tilt, azimuth) are stored as unit normals (east, north, up) and single-axis trackers as the sine and
+    // cosine of their axis tilt and azimuth, so per panel only a dot product is left and no degrees/radians conversion.
+    // setSun() turns the sun position into a unit vector once per instant.
+public:
+    SolarIncidence( int Capacity );
+    ~SolarIncidence( void );
+    int AddPanel( double Tilt, double Azimuth );
+    int AddTracker( double AxisTilt, double AxisAzimuth, double MaxRotation, double GroundCoverage );
+    int Panels( void );
+    int Trackers( void );
+    void setSun( double Elevation, double Azimuth );
+    void setSun( Solar& Sun );
+    void EvaluatePanels( double* CosIncidence );
+    void EvaluateTrackers( double* Rotation, double* CosIncidence );
+private:
+    SolarIncidence( const SolarIncidence& );
+    SolarIncidence& operator=( const SolarIncidence& );
+    int m_Capacity;
+    int m_Panels;
+    int m_Trackers;
+    double* m_East;         // panel normals
+    double* m_North;
+    double* m_Up;
+    double* m_SinAxisTilt;  // tracker axes
+    double* m_CosAxisTilt;
+    double* m_SinAxisAzimuth;
+    double* m_CosAxisAzimuth;
+    double* m_MaxRotation;
+    double* m_GroundCoverage;
+    double m_SunEast;       // sun vector
+    double m_SunNorth;
+    double m_SunUp;
+};
+//--------------------------------------------------------------------------------------------------
+
+#endif // SOLARINCIDENCE_H
@@ -0,0 +1,42 @@
+#include "SolarInstrument.h"
+
+#ifdef SOLAR_INSTRUMENT
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+
+static SolarInstrumentCounters s_Counters = { 0, 0, 0 };
+static SolarTraceCallback s_Trace = 0;
+
+//--------------------------------------------------------------------------------------------------
+SolarInstrumentCounters& SolarCounters( void ) {
+    return s_Counters;
+}
+//--------------------------------------------------------------------------------------------------
+void SolarResetCounters( void ) {
+    s_Counters.Evaluations     = 0;
+    s_Counters.TrigCalls       = 0;
+    s_Counters.JulianCenturies = 0;
+}
+//--------------------------------------------------------------------------------------------------
+void SolarSetTrace( SolarTraceCallback Callback ) { // 0 switches tracing off
+    s_Trace = Callback;
+}
+//--------------------------------------------------------------------------------------------------
+void SolarTrace( const char* Event, double Value ) {
+    if( s_Trace ) {
+        s_Trace( Event, Value );
+    }
+}
+//--------------------------------------------------------------------------------------------------
+uint32_t SolarMicros( void ) {
+#ifdef ARDUINO
+    return micros();
+#else
+    return ( uint32_t ) std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+#endif
+}
+//--------------------------------------------------------------------------------------------------
+#endif // SOLAR_INSTRUMENT
@@ -0,0 +1,56 @@
+#ifndef SOLARINSTRUMENT_H
+#define SOLARINSTRUMENT_H
+
+// Optional diagnostics for the Solar classes, compiled in only when SOLAR_INSTRUMENT is defined for the whole build
+// (-DSOLAR_INSTRUMENT, or cmake -DSOLAR_INSTRUMENT=ON). Without it every hook below expands to nothing.
+//
+//   SolarCounters()          evaluations of the NOAA chain, trig calls in it (counted by SolarSin() etc. of
+//                            SolarCore.h) and Julian century computations
+//   SolarResetCounters()
+//   SolarSetTrace( f )       f( Event, Value ) is called on setDateTime()/setTime()/setUnixTime() with the Julian day
+//                            and when a timed getter returns, with its duration in microseconds
+//
+// The counters are plain globals, not atomics: they are meant for one thread at a time while profiling.
+
+#ifdef SOLAR_INSTRUMENT
+
+#include <stdint.h>
+
+struct SolarInstrumentCounters {
+    uint32_t Evaluations;       // SolarPosition records computed
+    uint32_t TrigCalls;         // sin/cos/tan/asin/acos/atan calls inside the chain
+    uint32_t JulianCenturies;   // Julian century computations
+};
+
+typedef void ( *SolarTraceCallback )( const char* Event, double Value );
+
+SolarInstrumentCounters& SolarCounters( void );
+void SolarResetCounters( void );
+void SolarSetTrace( SolarTraceCallback Callback );
+void SolarTrace( const char* Event, double Value );
+uint32_t SolarMicros( void );
+
+class SolarScopedTimer {
+public:
+    SolarScopedTimer( const char* Name ) : m_Name( Name ), m_Start( SolarMicros() ) {}
+    ~SolarScopedTimer( void ) {
+        SolarTrace( m_Name, ( double )( uint32_t )( SolarMicros() - m_Start ) );
+    }
+private:
+    const char* m_Name;
+    uint32_t m_Start;
+};
+
+#define SOLAR_COUNT( Counter, n )   ( SolarCounters().Counter += ( n ) )
+#define SOLAR_TRACE( Event, Value ) SolarTrace( Event, Value )
+#define SOLAR_TIMER( Name )         SolarScopedTimer SolarTimer_( Name )
+
+#else
+
+#define SOLAR_COUNT( Counter, n )   ( ( void ) 0 )
+#define SOLAR_TRACE( Event, Value ) ( ( void ) 0 )
+#define SOLAR_TIMER( Name )         ( ( void ) 0 )
+
+#endif // SOLAR_INSTRUMENT
+
+#endif // SOLARINSTRUMENT_H
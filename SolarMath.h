@@ -0,0 +1,96 @@
+#ifndef SOLARMATH_H
+#define SOLARMATH_H
+
+#include <math.h>
+#include <stdint.h>
+
+//--------------------------------------------------------------------------------------------------
+template <typename T>
+struct SolarLibm {
+    // Trig for SolarFixed from the C library, float or double overloads depending on T
+    static T Sin( T x ) { return sin( x ); }
+    static T Cos( T x ) { return cos( x ); }
+    static T Tan( T x ) { return tan( x ); }
+    static T Asin( T x ) { return asin( x ); }
+    static T Acos( T x ) { return acos( x ); }
+    static T Atan2( T y, T x ) { return atan2( y, x ); }
+    static T Sqrt( T x ) { return sqrt( x ); }
+};
+//--------------------------------------------------------------------------------------------------
+struct SolarFastMath {
+    // Float trig for SolarFixed<Site, float, SolarFastMath> on micro controllers without an FPU (or a slow libm)
+    // Argument reduction to +-pi/4 and the minimax polynomials of the Cephes sinf/cosf/atanf, max error about 2e-7 rad
+    // for arguments up to a few hundred radians. Asin/Acos go through Atan2, Sqrt stays the library one.
+    static float Sin( float x ) {
+        return SinCos( x, 0 );
+    }
+    static float Cos( float x ) {
+        return SinCos( x, 2 );
+    }
+    static float Tan( float x ) {
+        return SinCos( x, 0 ) / SinCos( x, 2 );
+    }
+    static float Atan2( float y, float x ) {
+        if( x == 0.0f ) {
+            return ( y > 0.0f ) ? 1.5707963f : ( y < 0.0f ) ? -1.5707963f : 0.0f;
+        }
+        float a = Atan( y / x );
+        if( x < 0.0f ) {
+            a += ( y < 0.0f ) ? -3.1415927f : 3.1415927f;
+        }
+        return a;
+    }
+    static float Asin( float x ) { // NAN outside -1 .. 1 like asinf(), polar day and night depend on it
+        return ( x > 1.0f || x < -1.0f ) ? NAN : Atan2( x, Sqrt( 1.0f - x * x ) );
+    }
+    static float Acos( float x ) {
+        return ( x > 1.0f || x < -1.0f ) ? NAN : Atan2( Sqrt( 1.0f - x * x ), x );
+    }
+    static float Sqrt( float x ) {
+        return sqrtf( x > 0.0f ? x : 0.0f );
+    }
+private:
+    static float SinCos( float x, int Quadrant ) { // sin( x + Quadrant * pi/4 ), Quadrant 0 gives sine, 2 gives cosine
+        float s = ( x < 0.0f ) ? -1.0f : 1.0f;
+        if( Quadrant == 0 ) {
+            x *= s;                 // sine is odd: work on |x|, restore the sign at the end
+        } else {
+            s = 1.0f;
+            x = ( x < 0.0f ) ? -x : x; // cosine is even
+        }
+        int32_t j = ( int32_t )( x * 1.2732395f ); // 4 / pi
+        j += j & 1;
+        x = ( ( x - j * 0.78515625f ) - j * 2.4187564849853515625e-4f ) - j * 3.77489497744594108e-8f; // x - j * pi / 4 in three parts
+        j = ( j + Quadrant ) & 7;
+        if( j > 3 ) {
+            s = -s;
+            j -= 4;
+        }
+        float z = x * x;
+        float r;
+        if( j == 2 ) { // j is 0 or 2 here, 2 means the cosine polynomial
+            r = ( ( 2.443315711809948e-5f * z - 1.388731625493765e-3f ) * z + 4.166664568298827e-2f ) * z * z - 0.5f * z + 1.0f;
+        } else {       // sine polynomial
+            r = ( ( -1.9515295891e-4f * z + 8.3321608736e-3f ) * z - 1.6666654611e-1f ) * z * x + x;
+        }
+        return s * r;
+    }
+    static float Atan( float x ) {
+        float s = ( x < 0.0f ) ? -1.0f : 1.0f;
+        float y = 0.0f;
+        x *= s;
+        if( x > 2.414213562f ) {      // tan( 3pi/8 )
+            y = 1.5707963f;
+            x = -1.0f / x;
+        } else if( x > 0.4142135623f ) { // tan( pi/8 )
+            y = 0.78539816f;
+            x = ( x - 1.0f ) / ( x + 1.0f );
+        }
+        float z = x * x;
+        y += ( ( ( 8.05374449538e-2f * z - 1.38776856032e-1f ) * z + 1.99777106478e-1f ) * z - 3.33329491539e-1f ) * z * x + x;
+        return s * y;
+    }
+};
+//--------------------------------------------------------------------------------------------------
+
+#endif // SOLARMATH_H
@@ -0,0 +1,101 @@
+#include "SolarSchedule.h"
+
+//--------------------------------------------------------------------------------------------------
+SolarSchedule::SolarSchedule( double TimeZone, double Latitude, double Longitude, SolarSetpoint* Buffer, int Size ) : m_Solar( TimeZone, Latitude, Longitude ), m_Track( TimeZone, Latitude, Longitude ) {
+    m_Buffer = Buffer;
+    m_Size   = Size;
+    m_Count  = 0;
+    m_DeadbandAzimuth   = 1.0;
+    m_DeadbandElevation = 1.0;
+    m_Resolution = 60;
+}
+//--------------------------------------------------------------------------------------------------
+void SolarSchedule::setDeadband( double Azimuth, double Elevation ) { // degrees the sun may move before an axis follows
+    m_DeadbandAzimuth   = Azimuth;
+    m_DeadbandElevation = Elevation;
+}
+//--------------------------------------------------------------------------------------------------
+void SolarSchedule::setResolution( int32_t Seconds ) { // scan step, setpoints fall on multiples of it after sunrise
+    m_Resolution = Seconds;
+}
+//--------------------------------------------------------------------------------------------------
+int SolarSchedule::Count( void ) {
+    return m_Count;
+}
+//--------------------------------------------------------------------------------------------------
+int SolarSchedule::Plan( int Year, uint8_t Month, uint8_t Day ) {
+    // Returns the number of setpoints of the day, 0 when the sun stays down, -1 when the buffer is too small
+    // The first setpoint is at sunrise and the last one at sunset, with the sun up all day they are 00:00 and 24:00.
+    m_Count = 0;
+    m_Solar.setDateTime( Year, Month, Day, 12, 0 );
+    int64_t Midnight = m_Solar.getUnixTime() - 43200;
+    double Rise = m_Solar.SunriseTime(), Set = m_Solar.SunsetTime();
+    if( isnan( Rise ) || isnan( Set ) ) {
+        if( m_Solar.SolarElevation() < 0.0 ) {
+            return 0;
+        }
+        Rise = 0.0;
+        Set  = 1.0;
+    }
+    int64_t First = Midnight + ( int64_t )( Rise * 86400.0 );
+    int64_t Last  = Midnight + ( int64_t )( Set * 86400.0 );
+    m_Track.Start( First, m_Resolution, ( long )( ( Last - First ) / m_Resolution ) + 1 );
+    SolarSample Samples[16];
+    int n;
+    while( ( n = m_Track.Next( Samples, 16 ) ) > 0 ) {
+        for( int i = 0; i < n; i++ ) {
+            if( m_Count > 0 ) {
+                const SolarSetpoint& Previous = m_Buffer[m_Count - 1];
+                double dAzimuth = fabs( Samples[i].Azimuth - Previous.Azimuth );
+                dAzimuth = dAzimuth > 180.0 ? 360.0 - dAzimuth : dAzimuth;
+                if( dAzimuth <= m_DeadbandAzimuth && fabs( Samples[i].Elevation - Previous.Elevation ) <= m_DeadbandElevation ) {
+                    continue;
+                }
+            }
+            if( m_Count == m_Size ) {
+                m_Count = 0;
+                return -1;
+            }
+            m_Buffer[m_Count].UnixTime  = Samples[i].UnixTime;
+            m_Buffer[m_Count].Elevation = Samples[i].Elevation;
+            m_Buffer[m_Count].Azimuth   = Samples[i].Azimuth;
+            m_Count++;
+        }
+    }
+    if( m_Buffer[m_Count - 1].UnixTime < Last ) { // sunset itself, the tracker can stow from there
+        if( m_Count == m_Size ) {
+            m_Count = 0;
+            return -1;
+        }
+        m_Solar.setUnixTime( Last );
+        m_Buffer[m_Count].UnixTime  = Last;
+        m_Buffer[m_Count].Elevation = m_Solar.SolarElevation();
+        m_Buffer[m_Count].Azimuth   = m_Solar.SolarAzimuthAngle();
+        m_Count++;
+    }
+    return m_Count;
+}
+//--------------------------------------------------------------------------------------------------
+int SolarSchedule::Find( int64_t UnixTime ) { // index of the first setpoint after UnixTime, m_Count when there is none
+    int Low = 0, High = m_Count;
+    while( Low < High ) {
+        int Middle = ( Low + High ) / 2;
+        if( m_Buffer[Middle].UnixTime <= UnixTime ) {
+            Low = Middle + 1;
+        } else {
+            High = Middle;
+        }
+    }
+    return Low;
+}
+//--------------------------------------------------------------------------------------------------
+const SolarSetpoint* SolarSchedule::Setpoint( int64_t UnixTime ) { // setpoint in force at UnixTime, 0 before sunrise
+    int i = Find( UnixTime );
+    return i > 0 ? &m_Buffer[i - 1] : 0;
+}
+//--------------------------------------------------------------------------------------------------
+int64_t SolarSchedule::NextWakeup( int64_t UnixTime ) { // UTC of the next setpoint after UnixTime, -1 when the day is done
+    int i = Find( UnixTime );
+    return i < m_Count ? m_Buffer[i].UnixTime : -1;
+}
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,38 @@
+#ifndef SOLARSCHEDULE_H
+#define SOLARSCHEDULE_H
+
+#include "SolarTrack.h"
+
+//--------------------------------------------------------------------------------------------------
+struct SolarSetpoint {
+    int64_t UnixTime;   // UTC at which the tracker has to move
+    double Elevation;   // SolarElevation() at that time
+    double Azimuth;     // SolarAzimuthAngle() at that time
+};
+//--------------------------------------------------------------------------------------------------
+class SolarSchedule {
+    // Setpoints of a tracker for one day: a new setpoint only when the sun has moved more than the deadband of an
+    // axis since the last one, from sunrise to sunset. The controller can sleep until NextWakeup() instead of waking
+    // every minute. The sun is scanned with SolarTrack at the resolution step, setpoints go into a buffer of the caller.
+public:
+    SolarSchedule( double TimeZone, double Latitude, double Longitude, SolarSetpoint* Buffer, int Size );
+    void setDeadband( double Azimuth, double Elevation );
+    void setResolution( int32_t Seconds );
+    int Plan( int Year, uint8_t Month, uint8_t Day );
+    int Count( void );
+    const SolarSetpoint* Setpoint( int64_t UnixTime );
+    int64_t NextWakeup( int64_t UnixTime );
+private:
+    int Find( int64_t UnixTime );
+    Solar m_Solar;
+    SolarTrack m_Track;
+    SolarSetpoint* m_Buffer;
+    int m_Size;
+    int m_Count;
+    double m_DeadbandAzimuth;
+    double m_DeadbandElevation;
+    int32_t m_Resolution;
+};
+//--------------------------------------------------------------------------------------------------
+
+#endif // SOLARSCHEDULE_H
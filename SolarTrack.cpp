@@ -0,0 +1,83 @@
+#include "SolarTrack.h"
+
+//--------------------------------------------------------------------------------------------------
+SolarTrack::SolarTrack( double TimeZone, double Latitude, double Longitude ) : m_Solar( TimeZone, Latitude, Longitude ) {
+    m_Time      = 0;
+    m_Step      = 60;
+    m_Remaining = 0;
+    m_Refresh   = 21600;
+    m_NodeTime  = 0;
+    m_NodeValid = false;
+    m_NodeJulianDay = 0.0;
+    m_SunDeclin[0] = m_SunDeclin[1] = 0.0;
+    m_EqOfTime[0]  = m_EqOfTime[1]  = 0.0;
+    m_Solar.setEphemeris( this );
+}
+//--------------------------------------------------------------------------------------------------
+void SolarTrack::Start( int64_t UnixTime, int32_t StepSeconds, long Count ) { // Count samples from UnixTime (UTC) on
+    m_Time      = UnixTime;
+    m_Step      = StepSeconds;
+    m_Remaining = Count;
+    Refresh( UnixTime );
+}
+//--------------------------------------------------------------------------------------------------
+bool SolarTrack::setRefresh( int32_t Seconds ) { // interval between two evaluations of the full chain, 86400 = once a day
+    if( Seconds <= 0 ) { // keeps the current interval
+        return false;
+    }
+    m_Refresh   = Seconds;
+    m_NodeValid = false;
+    Refresh( m_Time );
+    return true;
+}
+//--------------------------------------------------------------------------------------------------
+long SolarTrack::Remaining( void ) {
+    return m_Remaining;
+}
+//--------------------------------------------------------------------------------------------------
+void SolarTrack::Refresh( int64_t UnixTime ) { // nodes are aligned to multiples of m_Refresh since 1970 so they can be shared
+    int64_t Node = UnixTime - UnixTime % m_Refresh;
+    if( UnixTime % m_Refresh < 0 ) {
+        Node -= m_Refresh;
+    }
+    if( m_NodeValid && Node == m_NodeTime + m_Refresh ) { // moving on to the next interval, the old end node is the new start node
+        m_SunDeclin[0] = m_SunDeclin[1];
+        m_EqOfTime[0]  = m_EqOfTime[1];
+    } else {
+        m_Solar.SunEphemeris( Node / 86400.0 + 2440587.5, m_SunDeclin[0], m_EqOfTime[0] );
+    }
+    m_NodeTime  = Node;
+    m_NodeValid = true;
+    m_NodeJulianDay = Node / 86400.0 + 2440587.5;
+    m_Solar.SunEphemeris( m_NodeJulianDay + m_Refresh / 86400.0, m_SunDeclin[1], m_EqOfTime[1] );
+}
+//--------------------------------------------------------------------------------------------------
+bool SolarTrack::Lookup( double JulianDay, double& SunDeclin, double& EqOfTime ) const {
+    // Only between the two nodes, anything else (noon of the day for the sun events) takes the full chain
+    double f = ( JulianDay - m_NodeJulianDay ) * 86400.0 / m_Refresh;
+    if( !( f >= 0.0 && f <= 1.0 ) ) {
+        return false;
+    }
+    SunDeclin = m_SunDeclin[0] + f * ( m_SunDeclin[1] - m_SunDeclin[0] );
+    EqOfTime  = m_EqOfTime[0] + f * ( m_EqOfTime[1] - m_EqOfTime[0] );
+    return true;
+}
+//--------------------------------------------------------------------------------------------------
+int SolarTrack::Next( SolarSample* Buffer, int Size ) { // returns the number of samples written, 0 at the end of the series
+    int n = 0;
+    while( n < Size && m_Remaining > 0 ) {
+        if( m_Time < m_NodeTime || m_Time >= m_NodeTime + m_Refresh ) {
+            Refresh( m_Time );
+        }
+        m_Solar.setUnixTime( m_Time );
+        Buffer[n].UnixTime  = m_Time;
+        Buffer[n].Elevation = m_Solar.SolarElevation();
+        Buffer[n].Azimuth   = m_Solar.SolarAzimuthAngle();
+        Buffer[n].DayTime   = m_Solar.DayTime();
+        m_Time += m_Step;
+        m_Remaining--;
+        n++;
+    }
+    return n;
+}
+//--------------------------------------------------------------------------------------------------
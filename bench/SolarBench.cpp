@@ -0,0 +1,394 @@
+#include "Solar.h"
+#include "SolarTrack.h"
+#include "SolarFleet.h"
+#include "SolarFixed.h"
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+// Benchmark and accuracy regression for the Solar class, host only (not part of an Arduino sketch)
+//
+//   SolarBench [reference.csv]           checks the reference table, then prints ns/call and sweep throughput
+//   SolarBench --check [reference.csv]   only runs the checks below (ctest)
+//   SolarBench --write [reference.csv]   regenerates the reference table from the current code
+//
+// The reference table holds SolarElevation, SolarAzimuthAngle, SunriseTime, SolarNoon and SunsetTime at fixed instants
+// for a handful of sites, checked for Solar and for SolarPositionUnix()/SolarEventsUnix() of SolarCore.h. Any change
+// to the code has to pass the check first, so a speed-up cannot move the results.
+// The table is written by this code, so --check also compares a few published values (NREL SPA test case, 2025
+// equinoxes and solstices) within the accuracy NOAA states for its calculator, and the fast paths (SolarPositions(),
+// SolarFleet, SolarTrack, SolarFixed<Site, double>) against Solar within the tolerance each of them documents.
+// Exit code 1 when a value moved by more than the tolerance below or turned into / out of NAN.
+
+#ifndef SOLAR_REFERENCE
+#define SOLAR_REFERENCE "SolarReference.csv"
+#endif
+
+//--------------------------------------------------------------------------------------------------
+struct BenchSite {
+    const char* Name;
+    double TimeZone;
+    double Latitude;
+    double Longitude;
+};
+
+static const BenchSite Sites[] = {
+    { "Zevenaar",   0.4038, 51.9291,    6.0565 },
+    { "Emmerich",   0.4233, 51.8520,    6.2598 },
+    { "Quito",     -5.1900, -0.1807,  -78.4678 },
+    { "Sydney",    10.0800, -33.8688, 151.2093 },
+    { "Tromso",     1.2900, 69.6492,   18.9553 },
+    { "Singapore",  6.9200,  1.3521,  103.8198 },
+};
+static const int SiteCount = sizeof( Sites ) / sizeof( Sites[0] );
+
+static const double AngleTolerance = 1e-6; // degrees
+static const double TimeTolerance  = 1e-8; // days, about 1 ms
+
+//--------------------------------------------------------------------------------------------------
+static int WriteReference( const char* Path ) {
+    FILE* f = fopen( Path, "w" );
+    if( !f ) {
+        printf( "cannot write %s\n", Path );
+        return 1;
+    }
+    fprintf( f, "# site,unixtime,elevation,azimuth,sunrise,noon,sunset\n" );
+    for( int s = 0; s < SiteCount; s++ ) {
+        Solar Sun( Sites[s].TimeZone, Sites[s].Latitude, Sites[s].Longitude );
+        for( int64_t t = -2145916800LL + s * 3631; t < 4070908800LL; t += 41000000LL + 12345 ) { // 1902 .. 2098, every 475 days
+            Sun.setUnixTime( t );
+            fprintf( f, "%d,%lld,%.10f,%.10f,%.12f,%.12f,%.12f\n", s, ( long long ) t, Sun.SolarElevation(), Sun.SolarAzimuthAngle(), Sun.SunriseTime(), Sun.SolarNoon(), Sun.SunsetTime() );
+        }
+    }
+    fclose( f );
+    printf( "reference written to %s\n", Path );
+    return 0;
+}
+//--------------------------------------------------------------------------------------------------
+static double Deviation( double Value, double Reference, bool& Mismatch ) { // 0 when both are NAN
+    if( isnan( Value ) || isnan( Reference ) ) {
+        Mismatch = Mismatch || isnan( Value ) != isnan( Reference );
+        return 0.0;
+    }
+    return fabs( Value - Reference );
+}
+//--------------------------------------------------------------------------------------------------
+static int CheckReference( const char* Path ) {
+    FILE* f = fopen( Path, "r" );
+    if( !f ) {
+        printf( "cannot read %s\n", Path );
+        return 1;
+    }
+    char Line[256];
+    int Rows = 0, Failed = 0;
+    double MaxAngle = 0.0, MaxTime = 0.0;
+    while( fgets( Line, sizeof( Line ), f ) ) {
+        int s;
+        long long t;
+        double e, a, r, n, u;
+        if( Line[0] == '#' || sscanf( Line, "%d,%lld,%lf,%lf,%lf,%lf,%lf", &s, &t, &e, &a, &r, &n, &u ) != 7 || s < 0 || s >= SiteCount ) {
+            continue;
+        }
+        Solar Sun( Sites[s].TimeZone, Sites[s].Latitude, Sites[s].Longitude );
+        Sun.setUnixTime( t );
+        // Every column on its own: NAN (polar day or night) has to stay NAN and a number has to stay a number
+        bool Mismatch = false;
+        double Angle = fmax( Deviation( Sun.SolarElevation(), e, Mismatch ), Deviation( Sun.SolarAzimuthAngle(), a, Mismatch ) );
+        double Time  = fmax( Deviation( Sun.SolarNoon(), n, Mismatch ), fmax( Deviation( Sun.SunriseTime(), r, Mismatch ), Deviation( Sun.SunsetTime(), u, Mismatch ) ) );
+        // SolarCore.h has to give the very same numbers as the Solar wrapper
+        SolarSite Site = SolarMakeSite( Sites[s].TimeZone, Sites[s].Latitude, Sites[s].Longitude );
+        SolarPosition p = SolarPositionUnix( Site, t );
+        SunEvents d = SolarEventsUnix( Site, t );
+        Angle = fmax( Angle, fmax( Deviation( p.SolarElevation, e, Mismatch ), Deviation( p.SolarAzimuthAngle, a, Mismatch ) ) );
+        Time  = fmax( Time, fmax( Deviation( d.SolarNoon, n, Mismatch ), fmax( Deviation( d.SunriseTime, r, Mismatch ), Deviation( d.SunsetTime, u, Mismatch ) ) ) );
+        MaxAngle = fmax( MaxAngle, Angle );
+        MaxTime  = fmax( MaxTime, Time );
+        if( Mismatch || Angle > AngleTolerance || Time > TimeTolerance ) {
+            if( Failed++ < 10 ) {
+                printf( "  moved: %s %lld elevation %.10f (%.10f) azimuth %.10f (%.10f) sunrise %.12f (%.12f) noon %.12f (%.12f) sunset %.12f (%.12f)%s\n", Sites[s].Name, t, Sun.SolarElevation(), e, Sun.SolarAzimuthAngle(), a, Sun.SunriseTime(), r, Sun.SolarNoon(), n, Sun.SunsetTime(), u, Mismatch ? " NAN mismatch" : "" );
+            }
+        }
+        Rows++;
+    }
+    fclose( f );
+    printf( "Accuracy regression: %d rows from %s, max deviation %.1e deg, %.1e days: %s\n", Rows, Path, MaxAngle, MaxTime, ( Failed || !Rows ) ? "FAILED" : "ok" );
+    return ( Failed || !Rows ) ? 1 : 0;
+}
+//--------------------------------------------------------------------------------------------------
+static int CheckAnchors( void ) {
+    // Values from outside this code: the SPA test case of NREL/TP-560-34302 (Reda & Andreas, 2003, Golden CO,
+    // 2003-10-17 12:30:30 at UTC-7) and the 2025 equinoxes and solstices of the USNO (UTC, to the minute).
+    // NOAA states its calculator to one minute of arc for the position. Sunrise and sunset are taken with the
+    // declination of noon, which moves them by about a minute against SPA in October at 40 degrees, so 90 s.
+    int Failed = 0;
+    double MaxAngle = 0.0, MaxTime = 0.0;
+    Solar Golden( -7.0, 39.742476, -105.1786 );
+    Golden.setDateTime( 2003, 10, 17, 12, 30, 30 );
+    MaxAngle = fmax( fabs( Golden.SolarElevation() - ( 90.0 - 50.11162 ) ), fabs( Golden.SolarAzimuthAngle() - 194.34024 ) );
+    MaxTime = fmax( fabs( Golden.SunriseTime() * 86400.0 - ( 6 * 3600 + 12 * 60 + 43 ) ), fabs( Golden.SunsetTime() * 86400.0 - ( 17 * 3600 + 20 * 60 + 19 ) ) );
+    if( MaxAngle > 1.0 / 60.0 || MaxTime > 90.0 || fabs( Golden.SolarNoon() * 86400.0 - ( 11 * 3600 + 46 * 60 + 4 ) ) > 15.0 ) {
+        printf( "  SPA test case: elevation %.5f azimuth %.5f sunrise %.0f s noon %.0f s sunset %.0f s\n", Golden.SolarElevation(), Golden.SolarAzimuthAngle(), Golden.SunriseTime() * 86400.0, Golden.SolarNoon() * 86400.0, Golden.SunsetTime() * 86400.0 );
+        Failed++;
+    }
+    // Declination 0 at the equinoxes and the obliquity of the ecliptic (23.436 degrees) at the solstices
+    static const uint8_t Month[] = { 3, 6, 9, 12 }, Day[] = { 20, 21, 22, 21 }, Hour[] = { 9, 2, 18, 15 }, Minute[] = { 1, 42, 19, 3 };
+    static const double Declination[] = { 0.0, 23.436, 0.0, -23.436 };
+    Solar Utc( 0.0, 0.0, 0.0 );
+    for( int i = 0; i < 4; i++ ) {
+        Utc.setDateTime( 2025, Month[i], Day[i], Hour[i], Minute[i] );
+        double d = fabs( Utc.SunDeclination() - Declination[i] );
+        MaxAngle = fmax( MaxAngle, d );
+        if( d > 0.01 ) {
+            printf( "  2025-%02d-%02d %02d:%02d UTC: declination %.5f (%.3f)\n", Month[i], Day[i], Hour[i], Minute[i], Utc.SunDeclination(), Declination[i] );
+            Failed++;
+        }
+    }
+    printf( "Published values: SPA test case and 2025 equinoxes/solstices, max deviation %.1e deg, %.0f s: %s\n", MaxAngle, MaxTime, Failed ? "FAILED" : "ok" );
+    return Failed ? 1 : 0;
+}
+//--------------------------------------------------------------------------------------------------
+struct FixedZevenaar {
+    static constexpr double TimeZone = 0.4038, Latitude = 51.9291, Longitude = 6.0565;
+};
+struct FixedTromso {
+    static constexpr double TimeZone = 1.29, Latitude = 69.6492, Longitude = 18.9553;
+};
+
+template <class Site>
+static void CheckFixed( double& MaxAngle, double& MaxTime, bool& Mismatch ) {
+    SolarFixed<Site, double> Fast;
+    Solar Sun( Site::TimeZone, Site::Latitude, Site::Longitude );
+    for( int64_t t = -2145916800LL; t < 4070908800LL; t += 1000000LL + 4321 ) {
+        Fast.setUnixTime( t );
+        Sun.setUnixTime( t );
+        MaxAngle = fmax( MaxAngle, Deviation( Fast.SolarElevation(), Sun.SolarElevation(), Mismatch ) );
+        MaxTime = fmax( MaxTime, fmax( Deviation( Fast.SunriseTime(), Sun.SunriseTime(), Mismatch ), Deviation( Fast.SunsetTime(), Sun.SunsetTime(), Mismatch ) ) );
+    }
+}
+//--------------------------------------------------------------------------------------------------
+static bool Report( const char* Name, double Deviation, double Tolerance, const char* Unit, bool Mismatch ) {
+    bool Ok = !Mismatch && Deviation <= Tolerance;
+    printf( "  %-40s max deviation %.2e %s (%.0e)%s: %s\n", Name, Deviation, Unit, Tolerance, Mismatch ? " mismatch" : "", Ok ? "ok" : "FAILED" );
+    return Ok;
+}
+//--------------------------------------------------------------------------------------------------
+static int CheckFastPaths( void ) {
+    // Each fast path against Solar for the same sites and instants, with the tolerance stated in its header
+    printf( "Fast paths against Solar:\n" );
+    bool Ok = true;
+
+    // SolarPositions(): 1e-11 degree elevation, 1e-8 degree azimuth (Solar.cpp)
+    const int N = 200;
+    int Year[N];
+    uint8_t Month[N], Day[N], Hour[N], Minute[N];
+    double Elevation[N], Azimuth[N], Zenith[N], Declination[N];
+    double MaxElevation = 0.0, MaxAzimuth = 0.0;
+    for( int s = 0; s < SiteCount; s++ ) {
+        Solar Sun( Sites[s].TimeZone, Sites[s].Latitude, Sites[s].Longitude );
+        for( int i = 0; i < N; i++ ) {
+            Year[i] = 1902 + i * 196 / N;
+            Month[i] = 1 + i % 12;
+            Day[i] = 1 + ( i * 7 ) % 28;
+            Hour[i] = ( i * 5 ) % 24;
+            Minute[i] = ( i * 13 ) % 60;
+        }
+        SolarInstants Instants = { Year, Month, Day, Hour, Minute };
+        Sun.SolarPositions( Instants, N, Elevation, Azimuth, Zenith, Declination );
+        for( int i = 0; i < N; i++ ) {
+            Sun.setDateTime( Year[i], Month[i], Day[i], Hour[i], Minute[i] );
+            MaxElevation = fmax( MaxElevation, fabs( Elevation[i] - Sun.SolarElevation() ) );
+            MaxAzimuth = fmax( MaxAzimuth, fabs( Azimuth[i] - Sun.SolarAzimuthAngle() ) );
+        }
+    }
+    Ok = Report( "SolarPositions() elevation", MaxElevation, 1e-11, "deg", false ) && Ok;
+    Ok = Report( "SolarPositions() azimuth", MaxAzimuth, 1e-8, "deg", false ) && Ok;
+
+    // SolarFleet::Evaluate(): Solar with time zone 0 to 2e-8 degree in elevation, 1e-8 in azimuth (SolarFleet.cpp)
+    SolarFleet Fleet( SiteCount );
+    for( int s = 0; s < SiteCount; s++ ) {
+        Fleet.AddSite( Sites[s].Latitude, Sites[s].Longitude );
+    }
+    double FleetElevation[SiteCount], FleetAzimuth[SiteCount];
+    MaxElevation = MaxAzimuth = 0.0;
+    for( int i = 0; i < N; i++ ) {
+        Fleet.setDateTime( Year[i], Month[i], Day[i], Hour[i], Minute[i] );
+        Fleet.Evaluate( FleetElevation, FleetAzimuth );
+        for( int s = 0; s < SiteCount; s++ ) {
+            Solar Sun( 0.0, Sites[s].Latitude, Sites[s].Longitude );
+            Sun.setDateTime( Year[i], Month[i], Day[i], Hour[i], Minute[i] );
+            MaxElevation = fmax( MaxElevation, fabs( FleetElevation[s] - Sun.SolarElevation() ) );
+            MaxAzimuth = fmax( MaxAzimuth, fabs( FleetAzimuth[s] - Sun.SolarAzimuthAngle() ) );
+        }
+    }
+    Ok = Report( "SolarFleet::Evaluate() elevation", MaxElevation, 2e-8, "deg", false ) && Ok;
+    Ok = Report( "SolarFleet::Evaluate() azimuth", MaxAzimuth, 1e-8, "deg", false ) && Ok;
+
+    // SolarTrack: 4e-6 degree in elevation with a 1 h refresh, 6e-4 with 6 h (SolarTrack.h), 2025 every 10 minutes.
+    // DayTime() has to be the one of Solar, the sun events of the day are not interpolated.
+    static const int32_t Refresh[] = { 3600, 21600 };
+    static const double TrackTolerance[] = { 4e-6, 6e-4 };
+    for( int r = 0; r < 2; r++ ) {
+        bool Mismatch = false;
+        MaxElevation = 0.0;
+        for( int s = 0; s < SiteCount; s++ ) {
+            SolarTrack Track( Sites[s].TimeZone, Sites[s].Latitude, Sites[s].Longitude );
+            Solar Sun( Sites[s].TimeZone, Sites[s].Latitude, Sites[s].Longitude );
+            SolarSample Buffer[256];
+            Mismatch = Mismatch || !Track.setRefresh( Refresh[r] ) || Track.setRefresh( 0 );
+            Track.Start( 1735689600LL, 600, 52560 );
+            int n;
+            while( ( n = Track.Next( Buffer, 256 ) ) > 0 ) {
+                for( int i = 0; i < n; i++ ) {
+                    Sun.setUnixTime( Buffer[i].UnixTime );
+                    MaxElevation = fmax( MaxElevation, fabs( Buffer[i].Elevation - Sun.SolarElevation() ) );
+                    Mismatch = Mismatch || Buffer[i].DayTime != Sun.DayTime();
+                }
+            }
+        }
+        Ok = Report( r ? "SolarTrack, 6 h refresh, elevation" : "SolarTrack, 1 h refresh, elevation", MaxElevation, TrackTolerance[r], "deg", Mismatch ) && Ok;
+    }
+
+    // SolarFixed<Site, double>: 1e-5 degree in elevation and 10 ms for sunrise and sunset (SolarFixed.h)
+    double MaxTime = 0.0;
+    bool Mismatch = false;
+    MaxElevation = 0.0;
+    CheckFixed<FixedZevenaar>( MaxElevation, MaxTime, Mismatch );
+    CheckFixed<FixedTromso>( MaxElevation, MaxTime, Mismatch );
+    Ok = Report( "SolarFixed<Site, double> elevation", MaxElevation, 1e-5, "deg", Mismatch ) && Ok;
+    Ok = Report( "SolarFixed<Site, double> sunrise/sunset", MaxTime * 86400.0, 1e-2, "s", Mismatch ) && Ok;
+    return Ok ? 0 : 1;
+}
+//--------------------------------------------------------------------------------------------------
+typedef double ( Solar::*Getter )( void );
+
+static double Now( void ) {
+    return std::chrono::duration<double>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+//--------------------------------------------------------------------------------------------------
+static void TimeGetter( const char* Name, Getter g ) {
+    // "new instant" moves the time by one minute before every call, "same instant" reads the cached state
+    const int N = 200000;
+    Solar Sun( Sites[0].TimeZone, Sites[0].Latitude, Sites[0].Longitude );
+    Sun.setUnixTime( 1735689600LL );
+    double Sum = 0.0;
+    double t0 = Now();
+    for( int i = 0; i < N; i++ ) {
+        Sun.DateCalc( 'm', 1 );
+        Sum += ( Sun.*g )();
+    }
+    double t1 = Now();
+    for( int i = 0; i < N; i++ ) {
+        Sum += ( Sun.*g )();
+    }
+    double t2 = Now();
+    printf( "  %-20s %9.1f %9.1f   (%g)\n", Name, ( t1 - t0 ) / N * 1e9, ( t2 - t1 ) / N * 1e9, Sum );
+}
+//--------------------------------------------------------------------------------------------------
+static double DayTimeAsDouble( Solar& Sun ) {
+    return Sun.DayTime() ? 1.0 : 0.0;
+}
+//--------------------------------------------------------------------------------------------------
+static void Benchmark( void ) {
+    const int N = 200000;
+    printf( "\nns/call, g++ %s build                new instant  same instant\n", __VERSION__ );
+    TimeGetter( "SolarElevation", &Solar::SolarElevation );
+    TimeGetter( "SolarAzimuthAngle", &Solar::SolarAzimuthAngle );
+    TimeGetter( "SunriseTime", &Solar::SunriseTime );
+    TimeGetter( "SunsetTime", &Solar::SunsetTime );
+    TimeGetter( "SolarNoon", &Solar::SolarNoon );
+
+    Solar Sun( Sites[0].TimeZone, Sites[0].Latitude, Sites[0].Longitude );
+    Sun.setUnixTime( 1735689600LL );
+    double Sum = 0.0;
+    double t0 = Now();
+    for( int i = 0; i < N; i++ ) {
+        Sun.DateCalc( 'm', 1 );
+        Sum += DayTimeAsDouble( Sun );
+    }
+    double t1 = Now();
+    for( int i = 0; i < N; i++ ) {
+        Sum += DayTimeAsDouble( Sun );
+    }
+    double t2 = Now();
+    printf( "  %-20s %9.1f %9.1f   (%g)\n", "DayTime", ( t1 - t0 ) / N * 1e9, ( t2 - t1 ) / N * 1e9, Sum );
+
+    SolarSite Site = SolarMakeSite( Sites[0].TimeZone, Sites[0].Latitude, Sites[0].Longitude );
+    t0 = Now();
+    for( int i = 0; i < N; i++ ) {
+        SolarPosition p = SolarPositionUnix( Site, 1735689600LL + i * 60LL );
+        Sum += p.SolarElevation + p.SolarAzimuthAngle;
+    }
+    t1 = Now();
+    printf( "  %-20s %9.1f             (%g)\n", "SolarPositionUnix", ( t1 - t0 ) / N * 1e9, Sum );
+
+    const char Parts[] = { 's', 'm', 'h', 'D', 'M', 'Y' };
+    for( int p = 0; p < 6; p++ ) {
+        char Name[32];
+        sprintf( Name, "DateCalc('%c', 1)", Parts[p] );
+        t0 = Now();
+        for( int i = 0; i < N; i++ ) {
+            Sun.DateCalc( Parts[p], ( i & 1 ) ? 1 : -1 );
+        }
+        t1 = Now();
+        printf( "  %-20s %9.1f\n", Name, ( t1 - t0 ) / N * 1e9 );
+    }
+    t0 = Now();
+    for( int i = 0; i < N; i++ ) {
+        Sun.DateCalc( 'm', ( i & 1 ) ? 525600 : -525600 );
+    }
+    t1 = Now();
+    printf( "  %-20s %9.1f\n", "DateCalc('m',525600)", ( t1 - t0 ) / N * 1e9 );
+
+    // Year long per-minute sweeps, elevation and azimuth of every minute of 2025 for every site
+    const long Minutes = 525600;
+    printf( "\nYear of minutes (2025), %d sites                 samples/s\n", SiteCount );
+    t0 = Now();
+    for( int s = 0; s < SiteCount; s++ ) {
+        Solar Site( Sites[s].TimeZone, Sites[s].Latitude, Sites[s].Longitude );
+        Site.setUnixTime( 1735689600LL );
+        for( long i = 0; i < Minutes; i++ ) {
+            Sum += Site.SolarElevation() + Site.SolarAzimuthAngle();
+            Site.DateCalc( 'm', 1 );
+        }
+    }
+    t1 = Now();
+    printf( "  %-44s %10.3g\n", "Solar: DateCalc + SolarElevation/Azimuth", SiteCount * Minutes / ( t1 - t0 ) );
+    t0 = Now();
+    for( int s = 0; s < SiteCount; s++ ) {
+        SolarTrack Track( Sites[s].TimeZone, Sites[s].Latitude, Sites[s].Longitude );
+        SolarSample Buffer[512];
+        Track.Start( 1735689600LL, 60, Minutes );
+        int n;
+        while( ( n = Track.Next( Buffer, 512 ) ) > 0 ) {
+            Sum += Buffer[n - 1].Elevation;
+        }
+    }
+    t1 = Now();
+    printf( "  %-44s %10.3g\n", "SolarTrack, 6 h refresh", SiteCount * Minutes / ( t1 - t0 ) );
+    printf( "(%g)\n", Sum );
+#ifdef SOLAR_INSTRUMENT
+    // Instrumented build: what one new instant costs inside the chain
+    Sun.DateCalc( 'm', 1 );
+    SolarResetCounters();
+    Sum += Sun.SolarElevation() + Sun.SolarAzimuthAngle() + Sun.SunriseTime();
+    printf( "\nElevation + azimuth + sunrise of one instant: %u evaluation(s), %u trig calls, %u Julian centuries\n", SolarCounters().Evaluations, SolarCounters().TrigCalls, SolarCounters().JulianCenturies );
+#endif
+}
+//--------------------------------------------------------------------------------------------------
+int main( int argc, char** argv ) {
+    if( argc > 1 && strcmp( argv[1], "--write" ) == 0 ) {
+        return WriteReference( argc > 2 ? argv[2] : SOLAR_REFERENCE );
+    }
+    if( argc > 1 && strcmp( argv[1], "--check" ) == 0 ) {
+        int Result = CheckReference( argc > 2 ? argv[2] : SOLAR_REFERENCE );
+        Result |= CheckAnchors();
+        return Result | CheckFastPaths();
+    }
+    int Result = CheckReference( argc > 1 ? argv[1] : SOLAR_REFERENCE );
+    Result |= CheckAnchors();
+    Result |= CheckFastPaths();
+    Benchmark();
+    return Result;
+}
+//--------------------------------------------------------------------------------------------------
@@ -1,4 +1,8 @@
 #include "Solar.h"
+#ifndef ARDUINO
+#include <stdio.h>
+#include <string.h>
+#endif
 
 //--------------------------------------------------------------------------------------------------
 
@@ -38,7 +42,259 @@ void loop() {
 //--------------------------------------------------------------------------------------------------
 #else // test environment, Code::Blocks on Linux
 //--------------------------------------------------------------------------------------------------
-int main() {
+#include "SolarEphemeris.h"
+
+void PrintDate( Solar& Sun ) {
+    printf( "%c %04d-%02d-%02d %02d:%02d:%02d\n", Sun.LeapYear() ? '*' : '-', Sun.GetYear(), Sun.GetMonth(), Sun.GetDay(), Sun.GetHours(), Sun.GetMinutes(), Sun.GetSeconds() );
+}
+
+template <typename T>
+bool EphemerisCheck( int FirstYear, int LastYear, int StepDays, double MaxDeclin, double MaxEqOfTime ) {
+    // A SolarEphemeris table against the full NOAA chain every 7 hours over its whole range. Declination and equation
+    // of time have to stay within the figures in SolarEphemeris.h, elevation, azimuth and sunrise are for information.
+    SolarEphemeris<T> Table( FirstYear, LastYear, StepDays );
+    Solar Full( 0.4038, 51.9291, 6.0565 );
+    Solar Fast( 0.4038, 51.9291, 6.0565 );
+    Fast.setEphemeris( &Table );
+    Full.setDate( FirstYear, 1, 1 );
+    Fast.setDate( FirstYear, 1, 1 );
+    double MaxD = 0.0, MaxE = 0.0, MaxElevation = 0.0, MaxAzimuth = 0.0, MaxSunrise = 0.0;
+    SolarSite Site = SolarMakeSite( 0.4038, 51.9291, 6.0565 );
+    double First = SolarDaysFromCivil( FirstYear, 1, 1 ) + 2440587.5, Last = SolarDaysFromCivil( LastYear + 1, 1, 1 ) + 2440587.5;
+    while( Full.GetYear() <= LastYear ) {
+        double JulianDay = SolarJulianDay( Site, SolarDaysFromCivil( Full.GetYear(), Full.GetMonth(), Full.GetDay() ), Full.GetHours() * 3600 + Full.GetMinutes() * 60 );
+        double d, e, Declin, EqOfTime;
+        Full.SunEphemeris( JulianDay, Declin, EqOfTime );
+        if( Table.Lookup( JulianDay, d, e ) ) {
+            MaxD = fmax( MaxD, fabs( d - Declin ) );
+            MaxE = fmax( MaxE, fabs( e - EqOfTime ) );
+        } else if( JulianDay >= First && JulianDay < Last ) {
+            MaxD = MaxE = INFINITY; // the table has to cover its whole range
+        }
+        MaxElevation = fmax( MaxElevation, fabs( Full.SolarElevation() - Fast.SolarElevation() ) );
+        MaxAzimuth   = fmax( MaxAzimuth, fabs( Full.SolarAzimuthAngle() - Fast.SolarAzimuthAngle() ) );
+        MaxSunrise   = fmax( MaxSunrise, fabs( Full.SunriseTime() - Fast.SunriseTime() ) * 86400.0 );
+        Full.DateCalc( 'h', 7 );
+        Fast.DateCalc( 'h', 7 );
+    }
+    bool Ok = MaxD <= MaxDeclin && MaxE <= MaxEqOfTime;
+    printf( "  %-6s %d-%d step %d day(s), %7ld bytes: declination %.1e deg, equation of time %.1e min, elevation %.1e deg, azimuth %.1e deg, sunrise %.1e s: %s\n", sizeof( T ) == sizeof( float ) ? "float" : "double", FirstYear, LastYear, StepDays, Table.Bytes(), MaxD, MaxE, MaxElevation, MaxAzimuth, MaxSunrise, Ok ? "ok" : "FAILED" );
+    return Ok;
+}
+//--------------------------------------------------------------------------------------------------
+class CountingEphemeris : public SolarEphemerisTable {
+    // The full NOAA chain behind the table interface, counts how often ElevationCrossing() evaluates it
+public:
+    CountingEphemeris( void ) : Lookups( 0 ) {}
+    bool Lookup( double JulianDay, double& SunDeclin, double& EqOfTime ) const {
+        Lookups++;
+        SolarSunEphemeris( ( JulianDay - 2451545.0 ) / 36525.0, SunDeclin, EqOfTime );
+        return true;
+    }
+    mutable long Lookups;
+};
+
+bool CrossingCheck( double Latitude, double Elevation, bool Refracted ) {
+    // ElevationCrossingsYear() for 2025, the elevation of the full chain at every returned time against the threshold.
+    // Within 5e-8 degree at no more than three chain evaluations per crossing on average is ok.
+    CountingEphemeris Counter;
+    Solar Sun( Latitude / 60.0, Latitude, Latitude / 4.0 );
+    Sun.setEphemeris( &Counter );
+    double Rise[366], Set[366];
+    int Days = Sun.ElevationCrossingsYear( 2025, Elevation, Rise, Set, Refracted );
+    SolarSite Site = SolarMakeSite( Latitude / 60.0, Latitude, Latitude / 4.0 );
+    int32_t First = SolarDaysFromCivil( 2025, 1, 1 );
+    double MaxError = 0.0;
+    int Crossings = 0;
+    for( int i = 0; i < 2 * Days; i++ ) {
+        double t = ( i < Days ) ? Rise[i] : Set[i - Days];
+        if( isnan( t ) ) {
+            continue;
+        }
+        double Declin, EqOfTime;
+        SolarSunEphemeris( ( First + i % Days + 2440587.5 + t - Site.TimeZone / 24.0 - 2451545.0 ) / 36525.0, Declin, EqOfTime );
+        double HourAngle = ( t * 1440.0 + EqOfTime + 4.0 * Site.Longitude - 60.0 * Site.TimeZone ) / 4.0 - 180.0;
+        double e = SolarDegrees( asin( Site.SinLatitude * sin( SolarRadians( Declin ) ) + Site.CosLatitude * cos( SolarRadians( Declin ) ) * cos( SolarRadians( HourAngle ) ) ) );
+        MaxError = fmax( MaxError, fabs( ( Refracted ? e + SolarRefraction( e ) : e ) - Elevation ) );
+        Crossings++;
+    }
+    double Evaluations = ( double ) Counter.Lookups / ( 2 * Days );
+    bool Ok = MaxError < 5e-8 && Evaluations <= 3.0;
+    printf( "  latitude %5.1f %7.3f deg %-9s %3d crossings, max error %.1e deg, %.2f evaluations per crossing: %s\n", Latitude, Elevation, Refracted ? "refracted" : "geometric", Crossings, MaxError, Evaluations, Ok ? "ok" : "FAILED" );
+    return Ok;
+}
+//--------------------------------------------------------------------------------------------------
+#include "SolarFixed.h"
+
+template <int Lat>
+struct GridSite {
+    static constexpr double TimeZone  = 0.0;
+    static constexpr double Latitude  = Lat;
+    static constexpr double Longitude = Lat / 4.0;
+};
+
+struct PrecisionError {
+    double Angle;   // degrees between the sun directions, sun above -1 degree
+    double Time;    // seconds, sunrise and sunset
+};
+
+template <class Engine>
+void PrecisionCheck( Engine& Fast, Solar& Full, PrecisionError& Error ) {
+    // Samples every 23 h 17 min from 1901 to 2099, Error keeps the maximum over all calls
+    const double Rad = 3.141592654 / 180.0;
+    for( int64_t t = -2177452800LL; t < 4102444800LL; t += 83820 ) {
+        Full.setUnixTime( t );
+        Fast.setUnixTime( t );
+        double e1 = Full.SolarElevation() * Rad, e2 = Fast.SolarElevation() * Rad;
+        if( e1 > -Rad ) {
+            double da = ( Full.SolarAzimuthAngle() - Fast.SolarAzimuthAngle() ) * Rad;
+            double h = sin( ( e1 - e2 ) / 2.0 ) * sin( ( e1 - e2 ) / 2.0 ) + cos( e1 ) * cos( e2 ) * sin( da / 2.0 ) * sin( da / 2.0 );
+            Error.Angle = fmax( Error.Angle, 2.0 * asin( sqrt( h ) ) / Rad );
+        }
+        Error.Time = fmax( Error.Time, fabs( Full.SunriseTime() - Fast.SunriseTime() ) * 86400.0 );
+        Error.Time = fmax( Error.Time, fabs( Full.SunsetTime() - Fast.SunsetTime() ) * 86400.0 );
+    }
+}
+
+template <typename T, class Math, int Lat>
+void PrecisionGrid( PrecisionError& Error ) {
+    SolarFixed<GridSite<Lat>, T, Math> Fast;
+    Solar Full( GridSite<Lat>::TimeZone, GridSite<Lat>::Latitude, GridSite<Lat>::Longitude );
+    PrecisionCheck( Fast, Full, Error );
+}
+
+template <typename T, class Math>
+bool PrecisionReport( const char* Name ) {
+    // Latitude grid -60 .. 60 degrees, sunrise and sunset exist every day there
+    PrecisionError Error = { 0.0, 0.0 };
+    PrecisionGrid<T, Math, -60>( Error );
+    PrecisionGrid<T, Math, -40>( Error );
+    PrecisionGrid<T, Math, -20>( Error );
+    PrecisionGrid<T, Math, 0>( Error );
+    PrecisionGrid<T, Math, 20>( Error );
+    PrecisionGrid<T, Math, 40>( Error );
+    PrecisionGrid<T, Math, 60>( Error );
+    // Pass: the 0.01 degree a tracker needs, and sunrise/sunset within a second
+    bool Ok = Error.Angle < 0.01 && Error.Time < 1.0;
+    printf( "  %-38s max angle %.1e deg, max sunrise/sunset %.2f s, %s the 0.01 deg / 1 s tolerance\n", Name, Error.Angle, Error.Time, Ok ? "meets" : "misses" );
+    return Ok;
+}
+//--------------------------------------------------------------------------------------------------
+#include "SolarIncidence.h"
+
+bool IncidenceCase( const char* Name, double Value, double Expected ) {
+    bool Ok = fabs( Value - Expected ) < 1e-3;
+    printf( "  %-52s %10.5f (%.5f): %s\n", Name, Value, Expected, Ok ? "ok" : "FAILED" );
+    return Ok;
+}
+
+bool IncidenceCheck( void ) {
+    // Hand computed cases, the expected values do not use SolarIncidence
+    const double Rad = 3.141592654 / 180.0;
+    bool Ok = true;
+    SolarIncidence Panels( 2 );
+    Panels.AddPanel( 0.0, 0.0 );       // flat
+    Panels.AddPanel( 30.0, 180.0 );    // 30 degrees towards the south
+    double CosIncidence[2];
+    Panels.setSun( 60.0, 180.0 );      // straight onto the tilted panel
+    Panels.EvaluatePanels( CosIncidence );
+    Ok = IncidenceCase( "flat panel, sun at 60 deg: sin( elevation )", CosIncidence[0], sin( 60.0 * Rad ) ) && Ok;
+    Ok = IncidenceCase( "30 deg south panel, sun 60 deg south: normal", CosIncidence[1], 1.0 ) && Ok;
+    Panels.setSun( 30.0, 135.0 );
+    Panels.EvaluatePanels( CosIncidence );
+    Ok = IncidenceCase( "flat panel, sun at 30 deg south-east", CosIncidence[0], 0.5 ) && Ok;
+
+    // Horizontal north-south axes: without backtracking, limited to 45 degrees, and rows at a ground coverage of 0.4
+    SolarIncidence Trackers( 3 );
+    Trackers.AddTracker( 0.0, 0.0, 90.0, 0.0 );
+    Trackers.AddTracker( 0.0, 0.0, 45.0, 0.0 );
+    Trackers.AddTracker( 0.0, 0.0, 60.0, 0.4 );
+    double Rotation[3], Incidence[3];
+    Trackers.setSun( 40.0, 90.0 );     // due east, the tracker turns 50 degrees to face it
+    Trackers.EvaluateTrackers( Rotation, Incidence );
+    Ok = IncidenceCase( "tracker, sun 40 deg east: rotation", Rotation[0], 50.0 ) && Ok;
+    Ok = IncidenceCase( "tracker, sun 40 deg east: normal incidence", Incidence[0], 1.0 ) && Ok;
+    Ok = IncidenceCase( "tracker limited to 45 deg: cos( 5 deg )", Incidence[1], cos( 5.0 * Rad ) ) && Ok;
+    // Sun 5 degrees above the eastern horizon: the ideal rotation is 85 degrees, backtracking turns back until the shadow
+    // of the next row ends at its edge, 85 - acos( cos( 85 ) / 0.4 ) = 7.585 degrees. With the sun at azimuth 100 the
+    // ideal rotation is atan( cos( 5 ) sin( 100 ) / sin( 5 ) ) = 84.923, backtracked 7.704 degrees.
+    Trackers.setSun( 5.0, 90.0 );
+    Trackers.EvaluateTrackers( Rotation, Incidence );
+    Ok = IncidenceCase( "backtracking, GCR 0.4, sun 5 deg east: rotation", Rotation[2], 7.585 ) && Ok;
+    Ok = IncidenceCase( "backtracking, GCR 0.4, sun 5 deg east: cos( 77.415 )", Incidence[2], cos( 77.415 * Rad ) ) && Ok;
+    Trackers.setSun( 5.0, 100.0 );
+    Trackers.EvaluateTrackers( Rotation, Incidence );
+    Ok = IncidenceCase( "backtracking, GCR 0.4, sun 5 deg at azimuth 100", Rotation[2], 7.704 ) && Ok;
+    Trackers.setSun( -2.0, 90.0 );
+    Trackers.EvaluateTrackers( Rotation, Incidence );
+    Ok = IncidenceCase( "sun below the horizon: stowed flat", Rotation[0], 0.0 ) && Ok;
+    return Ok;
+}
+//--------------------------------------------------------------------------------------------------
+#include "SolarSchedule.h"
+
+bool ScheduleCase( const char* Name, bool Ok ) {
+    printf( "  %-60s %s\n", Name, Ok ? "ok" : "FAILED" );
+    return Ok;
+}
+
+bool ScheduleCheck( void ) {
+    // Zevenaar on 2025-06-21 with a deadband of 2 degrees azimuth and 1 degree elevation: about 150 setpoints, the first
+    // at sunrise and the last at sunset, and between two setpoints the sun stays within the deadband of the first one.
+    static SolarSetpoint Buffer[400];
+    bool Ok = true;
+    SolarSchedule Schedule( 0.4038, 51.9291, 6.0565, Buffer, 400 );
+    Schedule.setDeadband( 2.0, 1.0 );
+    int Count = Schedule.Plan( 2025, 6, 21 );
+    Solar Sun( 0.4038, 51.9291, 6.0565 );
+    Sun.setDateTime( 2025, 6, 21, 0, 0 );
+    int64_t Midnight = Sun.getUnixTime();
+    bool Edges = Count > 0 && Buffer[0].UnixTime == Midnight + ( int64_t )( Sun.SunriseTime() * 86400.0 ) && Buffer[Count - 1].UnixTime == Midnight + ( int64_t )( Sun.SunsetTime() * 86400.0 );
+    printf( "  52 deg north, June 21st: %d setpoints\n", Count );
+    Ok = ScheduleCase( "52 deg north, June 21st: 140 .. 160 setpoints, sunrise to sunset", Count >= 140 && Count <= 160 && Edges ) && Ok;
+    bool Deadband = true;
+    for( int i = 1; i < Count; i++ ) {
+        for( int64_t t = Buffer[i - 1].UnixTime + 60; t < Buffer[i].UnixTime; t += 60 ) {
+            Sun.setUnixTime( t );
+            double dAzimuth = fabs( Sun.SolarAzimuthAngle() - Buffer[i - 1].Azimuth );
+            dAzimuth = dAzimuth > 180.0 ? 360.0 - dAzimuth : dAzimuth;
+            Deadband = Deadband && dAzimuth <= 2.0 + 1e-3 && fabs( Sun.SolarElevation() - Buffer[i - 1].Elevation ) <= 1.0 + 1e-3;
+        }
+    }
+    Ok = ScheduleCase( "every minute within the deadband of the setpoint in force", Deadband ) && Ok;
+
+    // Setpoint() and NextWakeup() around the first and the last setpoint
+    int64_t First = Buffer[0].UnixTime, Last = Buffer[Count - 1].UnixTime;
+    Ok = ScheduleCase( "before sunrise: no setpoint, wake up at the first", Schedule.Setpoint( First - 1 ) == 0 && Schedule.NextWakeup( First - 1 ) == First ) && Ok;
+    Ok = ScheduleCase( "at the first setpoint: the first, wake up at the second", Schedule.Setpoint( First ) == &Buffer[0] && Schedule.NextWakeup( First ) == Buffer[1].UnixTime ) && Ok;
+    Ok = ScheduleCase( "just before the second: still the first", Schedule.Setpoint( Buffer[1].UnixTime - 1 ) == &Buffer[0] && Schedule.NextWakeup( Buffer[1].UnixTime - 1 ) == Buffer[1].UnixTime ) && Ok;
+    Ok = ScheduleCase( "at sunset: the last one, no wake up (-1)", Schedule.Setpoint( Last ) == &Buffer[Count - 1] && Schedule.NextWakeup( Last ) == -1 ) && Ok;
+
+    // A buffer too small fails with -1 and leaves no plan: during the day (10) or at the sunset setpoint (one short)
+    SolarSchedule Small( 0.4038, 51.9291, 6.0565, Buffer, 10 );
+    Small.setDeadband( 2.0, 1.0 );
+    Ok = ScheduleCase( "buffer of 10 setpoints: -1, Count() 0", Small.Plan( 2025, 6, 21 ) == -1 && Small.Count() == 0 ) && Ok;
+    SolarSchedule Short( 0.4038, 51.9291, 6.0565, Buffer, Count - 1 );
+    Short.setDeadband( 2.0, 1.0 );
+    Ok = ScheduleCase( "buffer one setpoint too small: -1, Count() 0", Short.Plan( 2025, 6, 21 ) == -1 && Short.Count() == 0 && Short.NextWakeup( First - 1 ) == -1 ) && Ok;
+    SolarSchedule Exact( 0.4038, 51.9291, 6.0565, Buffer, Count );
+    Exact.setDeadband( 2.0, 1.0 );
+    Ok = ScheduleCase( "buffer exactly large enough", Exact.Plan( 2025, 6, 21 ) == Count ) && Ok;
+
+    // Tromso: the sun stays up on June 21st (00:00 to 24:00) and down on December 21st (no setpoints)
+    SolarSchedule Polar( 1.29, 69.6492, 18.9553, Buffer, 400 );
+    Polar.setDeadband( 2.0, 1.0 );
+    Sun = Solar( 1.29, 69.6492, 18.9553 );
+    Sun.setDateTime( 2025, 6, 21, 0, 0 );
+    Midnight = Sun.getUnixTime();
+    Count = Polar.Plan( 2025, 6, 21 );
+    Ok = ScheduleCase( "polar day: setpoints from 00:00 to 24:00", Count > 0 && Buffer[0].UnixTime == Midnight && Buffer[Count - 1].UnixTime == Midnight + 86400 ) && Ok;
+    Count = Polar.Plan( 2025, 12, 21 );
+    Ok = ScheduleCase( "polar night: no setpoints, no setpoint in force, no wake up", Count == 0 && Polar.Setpoint( Midnight ) == 0 && Polar.NextWakeup( Midnight ) == -1 ) && Ok;
+    return Ok;
+}
+//--------------------------------------------------------------------------------------------------
+void Demo( void ) {
     // parameters: Time zone, Latitude, Longitude
     Solar m_Solar( 0.4038, 51.9291, 6.0565 ); // Zevenaar
 
@@ -50,7 +306,7 @@ int main() {
     for( int i = 0; i < 50; i++ ) {
         m_Solar.DateCalc( 'Y', -25 );
         printf( "  DateCalc( 'Y', -25 );\t" );
-        m_Solar.DebugPrint();
+        PrintDate( m_Solar );
     }
 
     printf( "\nDay time on: " );
@@ -68,11 +324,65 @@ int main() {
     printf( "\nSolarNoon:\t%02d:%02d\t%.5f\t", ( int )( m_Solar.SolarNoon() * 24.0 ), ( int )( m_Solar.SolarNoon() * 1440 ) % 60, m_Solar.SolarNoon() );
     printf( "\nSunsetTime:\t%02d:%02d\t%.5f\t", ( int )( m_Solar.SunsetTime() * 24.0 ), ( int )( m_Solar.SunsetTime() * 1440 ) % 60, m_Solar.SunsetTime() );
     printf( "\nSunsetDegrees:\t\t%.5f", m_Solar.SunsetDegrees() );
+    double Dawn, Dusk;
+    if( m_Solar.ElevationCrossings( -6.0, Dawn, Dusk ) ) {
+        printf( "\nCivil twilight:\t%02d:%02d - %02d:%02d", ( int )( Dawn * 24.0 ), ( int )( Dawn * 1440 ) % 60, ( int )( Dusk * 24.0 ), ( int )( Dusk * 1440 ) % 60 );
+    }
     printf( "\nSolarElevation:\t\t%.5f", m_Solar.SolarElevation() );
     printf( "\nSolarAzimuthAngle:\t%.5f", m_Solar.SolarAzimuthAngle() );
     printf( "\n" );
+}
+//--------------------------------------------------------------------------------------------------
+int main( int argc, char** argv ) {
+    // Without arguments the demo and all checks run, with the name of a check only that one (ctest). Exit code 1 when
+    // a check failed.
+    const char* Only = ( argc > 1 ) ? argv[1] : 0;
+    bool Ok = true;
+    if( Only && strcmp( Only, "ephemeris" ) != 0 && strcmp( Only, "crossings" ) != 0 && strcmp( Only, "precision" ) != 0 && strcmp( Only, "incidence" ) != 0 && strcmp( Only, "schedule" ) != 0 ) {
+        printf( "usage: %s [ephemeris | crossings | precision | incidence | schedule]\n", argv[0] );
+        return 1;
+    }
+    if( !Only ) {
+        Demo();
+    }
+
+    if( !Only || strcmp( Only, "ephemeris" ) == 0 ) {
+        printf( "\nEphemeris tables against the full NOAA chain, limits of SolarEphemeris.h:\n" );
+        Ok = EphemerisCheck<double>( 1901, 2099, 1, 1.5e-7, 5e-7 ) && Ok;
+        Ok = EphemerisCheck<float>( 1901, 2099, 1, 1.5e-6, 2e-6 ) && Ok;
+        Ok = EphemerisCheck<float>( 2020, 2039, 4, 3e-5, 1.5e-4 ) && Ok;
+        Ok = EphemerisCheck<float>( 2025, 2034, 8, 5e-4, 2e-3 ) && Ok;
+    }
+
+    if( !Only || strcmp( Only, "crossings" ) == 0 ) {
+        printf( "\nElevationCrossingsYear() against the full NOAA chain, 2025:\n" );
+        Ok = CrossingCheck( 0.0, -0.833, false ) && Ok;
+        Ok = CrossingCheck( 51.9, -6.0, false ) && Ok;
+        Ok = CrossingCheck( 51.9, -18.0, false ) && Ok;
+        Ok = CrossingCheck( -35.0, 30.0, false ) && Ok;
+        Ok = CrossingCheck( 65.0, -0.833, false ) && Ok;
+        Ok = CrossingCheck( 51.9, 0.0, true ) && Ok;
+        Ok = CrossingCheck( 51.9, 5.0, true ) && Ok;
+    }
+
+    if( !Only || strcmp( Only, "precision" ) == 0 ) {
+        printf( "\nSolarFixed against Solar, 1901-2099, latitude -60 .. 60:\n" );
+        Ok = PrecisionReport<double, SolarLibm<double> >( "SolarFixed<Site, double>" ) && Ok;
+        Ok = PrecisionReport<float, SolarLibm<float> >( "SolarFixed<Site, float>" ) && Ok;
+        Ok = PrecisionReport<float, SolarFastMath>( "SolarFixed<Site, float, SolarFastMath>" ) && Ok;
+    }
+
+    if( !Only || strcmp( Only, "incidence" ) == 0 ) {
+        printf( "\nSolarIncidence, hand computed panels and trackers:\n" );
+        Ok = IncidenceCheck() && Ok;
+    }
+
+    if( !Only || strcmp( Only, "schedule" ) == 0 ) {
+        printf( "\nSolarSchedule, 2 deg azimuth / 1 deg elevation deadband:\n" );
+        Ok = ScheduleCheck() && Ok;
+    }
 
-    return 0;
+    return Ok ? 0 : 1;
 }
 //--------------------------------------------------------------------------------------------------
 #endif
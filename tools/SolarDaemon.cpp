@@ -0,0 +1,449 @@
+#include "SolarCore.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Local query server for sun positions and events, host only (Linux / POSIX, UNIX domain socket)
+//
+//   SolarDaemon [--cache Entries] socket                     serves until killed
+//   SolarDaemon --load socket Clients Queries                load test against a running server, prints its stats
+//
+// One request per line, every line gets one line back:
+//   P latitude longitude timezone unixtime   ->  elevation azimuth
+//   E latitude longitude timezone unixtime   ->  sunrise noon sunset of the local day (fractions of it, nan without one)
+//   S                                        ->  requests, cache hit rate, batch size and latency percentiles
+//
+// Positions are taken at the start of their minute and events belong to the local day, so all P queries within one
+// minute and all E queries within one day share a cache entry. Connection threads hand all complete lines they have
+// read to a single evaluator as one batch and wait. The evaluator takes every batch that is waiting, answers from an
+// LRU cache keyed by (kind, site, minute or day) and computes each distinct miss once, so concurrent clients asking
+// the same share one evaluation.
+//
+// The site in the key is quantized to micro-degrees and micro-hours and evaluated from those integers, so a value
+// with up to six decimals gives exactly the same answer as Solar. Coordinates that are not finite or out of range are
+// answered with "error", a line longer than DaemonMaxLine closes the connection.
+
+static const size_t DaemonMaxLine = 256;
+
+//--------------------------------------------------------------------------------------------------
+struct DaemonKey {
+    int32_t Latitude;   // micro-degrees
+    int32_t Longitude;  // micro-degrees
+    int32_t TimeZone;   // micro-hours
+    int64_t Instant;    // 'P': minutes since 1970 UTC, 'E': local day number
+    char Kind;
+    bool operator==( const DaemonKey& k ) const {
+        return Kind == k.Kind && Latitude == k.Latitude && Longitude == k.Longitude && TimeZone == k.TimeZone && Instant == k.Instant;
+    }
+};
+
+struct DaemonKeyHash {
+    size_t operator()( const DaemonKey& k ) const {
+        uint64_t h = ( ( uint64_t ) k.Instant * 2 + ( k.Kind == 'E' ) ) * 0x9E3779B97F4A7C15ULL;
+        const int32_t Parts[] = { k.Latitude, k.Longitude, k.TimeZone };
+        for( int i = 0; i < 3; i++ ) {
+            h = ( h ^ ( uint32_t ) Parts[i] ) * 0x100000001B3ULL;
+        }
+        return ( size_t )( h ^ ( h >> 29 ) );
+    }
+};
+
+struct DaemonValue {
+    double Elevation;
+    double Azimuth;
+    double Sunrise;
+    double Noon;
+    double Sunset;
+};
+
+struct DaemonQuery {
+    DaemonKey Key;
+    DaemonValue Value;
+};
+
+struct DaemonBatch {
+    DaemonQuery* Queries;
+    size_t Count;
+    bool Done;
+};
+//--------------------------------------------------------------------------------------------------
+class DaemonCache {
+    // Least recently used (site, minute) results, a list in use order plus a hash index into it
+public:
+    DaemonCache( size_t Capacity ) : m_Capacity( Capacity ) {}
+    bool Find( const DaemonKey& Key, DaemonValue& Value ) {
+        Index::iterator i = m_Index.find( Key );
+        if( i == m_Index.end() ) {
+            return false;
+        }
+        m_Entries.splice( m_Entries.begin(), m_Entries, i->second );
+        Value = i->second->Value;
+        return true;
+    }
+    void Insert( const DaemonQuery& Query ) {
+        if( m_Capacity == 0 ) {
+            return;
+        }
+        if( m_Index.size() >= m_Capacity ) {
+            m_Index.erase( m_Entries.back().Key );
+            m_Entries.pop_back();
+        }
+        m_Entries.push_front( Query );
+        m_Index[Query.Key] = m_Entries.begin();
+    }
+private:
+    typedef std::unordered_map<DaemonKey, std::list<DaemonQuery>::iterator, DaemonKeyHash> Index;
+    size_t m_Capacity;
+    std::list<DaemonQuery> m_Entries;
+    Index m_Index;
+};
+//--------------------------------------------------------------------------------------------------
+class DaemonEvaluator {
+public:
+    DaemonEvaluator( size_t CacheEntries ) : m_Cache( CacheEntries ) {
+        m_Requests = m_Hits = m_Batches = m_Evaluations = 0;
+        m_Latency.assign( 8192, 0.0 );
+        m_LatencyCount = 0;
+    }
+    void Submit( DaemonQuery* Queries, size_t Count );
+    void Run( void );
+    void Record( double Microseconds );
+    std::string Stats( void );
+private:
+    void Evaluate( std::vector<DaemonBatch*>& Batches );
+    DaemonCache m_Cache;
+    std::mutex m_Lock;
+    std::condition_variable m_Pending;
+    std::condition_variable m_Done;
+    std::vector<DaemonBatch*> m_Queue;
+    uint64_t m_Requests;
+    uint64_t m_Hits;
+    uint64_t m_Batches;     // evaluator passes
+    uint64_t m_Evaluations; // chain evaluations, one per distinct miss
+    std::mutex m_StatsLock;
+    std::vector<double> m_Latency; // last samples in microseconds, a ring
+    uint64_t m_LatencyCount;
+};
+//--------------------------------------------------------------------------------------------------
+void DaemonEvaluator::Submit( DaemonQuery* Queries, size_t Count ) { // blocks until every query has its value
+    DaemonBatch Batch = { Queries, Count, false };
+    std::unique_lock<std::mutex> Lock( m_Lock );
+    m_Queue.push_back( &Batch );
+    m_Pending.notify_one();
+    m_Done.wait( Lock, [ &Batch ]() { return Batch.Done; } );
+}
+//--------------------------------------------------------------------------------------------------
+void DaemonEvaluator::Run( void ) {
+    std::vector<DaemonBatch*> Batches;
+    for( ;; ) {
+        {
+            std::unique_lock<std::mutex> Lock( m_Lock );
+            m_Pending.wait( Lock, [ this ]() { return !m_Queue.empty(); } );
+            Batches.swap( m_Queue );
+        }
+        Evaluate( Batches );
+        {
+            std::lock_guard<std::mutex> Lock( m_Lock );
+            for( size_t b = 0; b < Batches.size(); b++ ) {
+                Batches[b]->Done = true;
+            }
+        }
+        m_Done.notify_all();
+        Batches.clear();
+    }
+}
+//--------------------------------------------------------------------------------------------------
+void DaemonEvaluator::Evaluate( std::vector<DaemonBatch*>& Batches ) {
+    // Cache hits first, then one evaluation per distinct missing key of all waiting batches together
+    std::unordered_map<DaemonKey, std::vector<DaemonQuery*>, DaemonKeyHash> Misses;
+    uint64_t Requests = 0, Hits = 0;
+    for( size_t b = 0; b < Batches.size(); b++ ) {
+        for( size_t i = 0; i < Batches[b]->Count; i++ ) {
+            DaemonQuery& q = Batches[b]->Queries[i];
+            Requests++;
+            if( m_Cache.Find( q.Key, q.Value ) ) {
+                Hits++;
+            } else {
+                Misses[q.Key].push_back( &q );
+            }
+        }
+    }
+    for( auto m = Misses.begin(); m != Misses.end(); ++m ) {
+        const DaemonKey& k = m->first;
+        SolarSite Site = SolarMakeSite( k.TimeZone / 1e6, k.Latitude / 1e6, k.Longitude / 1e6 );
+        DaemonQuery Result = { k, { NAN, NAN, NAN, NAN, NAN } };
+        if( k.Kind == 'E' ) {
+            SunEvents e = SolarEventsAt( Site, ( int32_t ) k.Instant );
+            Result.Value.Sunrise = e.SunriseTime;
+            Result.Value.Noon    = e.SolarNoon;
+            Result.Value.Sunset  = e.SunsetTime;
+        } else {
+            SolarPosition p = SolarPositionUnix( Site, k.Instant * 60 );
+            Result.Value.Elevation = p.SolarElevation;
+            Result.Value.Azimuth   = p.SolarAzimuthAngle;
+        }
+        for( size_t i = 0; i < m->second.size(); i++ ) {
+            m->second[i]->Value = Result.Value;
+        }
+        m_Cache.Insert( Result );
+    }
+    std::lock_guard<std::mutex> Lock( m_StatsLock );
+    m_Requests    += Requests;
+    m_Hits        += Hits;
+    m_Batches     += 1;
+    m_Evaluations += Misses.size();
+}
+//--------------------------------------------------------------------------------------------------
+void DaemonEvaluator::Record( double Microseconds ) {
+    std::lock_guard<std::mutex> Lock( m_StatsLock );
+    m_Latency[m_LatencyCount++ % m_Latency.size()] = Microseconds;
+}
+//--------------------------------------------------------------------------------------------------
+std::string DaemonEvaluator::Stats( void ) {
+    std::vector<double> Latency;
+    char Line[256];
+    std::lock_guard<std::mutex> Lock( m_StatsLock );
+    Latency.assign( m_Latency.begin(), m_Latency.begin() + std::min<uint64_t>( m_LatencyCount, m_Latency.size() ) );
+    std::sort( Latency.begin(), Latency.end() );
+    double p[3] = { 0.0, 0.0, 0.0 };
+    const double Rank[3] = { 0.50, 0.90, 0.99 };
+    for( int i = 0; i < 3 && !Latency.empty(); i++ ) {
+        p[i] = Latency[( size_t )( Rank[i] * ( Latency.size() - 1 ) )];
+    }
+    snprintf( Line, sizeof( Line ), "requests %llu hitrate %.4f evaluations %llu batch %.1f latency_us p50 %.1f p90 %.1f p99 %.1f\n", ( unsigned long long ) m_Requests, m_Requests ? ( double ) m_Hits / m_Requests : 0.0, ( unsigned long long ) m_Evaluations, m_Batches ? ( double ) m_Requests / m_Batches : 0.0, p[0], p[1], p[2] );
+    return Line;
+}
+//--------------------------------------------------------------------------------------------------
+static double Now( void ) {
+    return std::chrono::duration<double>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+//--------------------------------------------------------------------------------------------------
+static bool WriteAll( int Socket, const std::string& Text ) {
+    size_t Sent = 0;
+    while( Sent < Text.size() ) {
+        ssize_t n = write( Socket, Text.data() + Sent, Text.size() - Sent );
+        if( n <= 0 ) {
+            return false;
+        }
+        Sent += ( size_t ) n;
+    }
+    return true;
+}
+//--------------------------------------------------------------------------------------------------
+static bool MakeKey( char Kind, double Latitude, double Longitude, double TimeZone, long long UnixTime, DaemonKey& Key ) {
+    // False for anything that is not a site on earth or a time within a few thousand years, NAN fails every test
+    if( !( Latitude >= -90.0 && Latitude <= 90.0 && Longitude >= -180.0 && Longitude <= 180.0 && TimeZone >= -14.0 && TimeZone <= 14.0 ) || UnixTime < -100000000000LL || UnixTime > 100000000000LL ) {
+        return false;
+    }
+    Key.Kind      = Kind;
+    Key.Latitude  = ( int32_t ) llround( Latitude * 1e6 );
+    Key.Longitude = ( int32_t ) llround( Longitude * 1e6 );
+    Key.TimeZone  = ( int32_t ) llround( TimeZone * 1e6 );
+    int32_t Day, Seconds;
+    SolarLocalTime( SolarUnixOffset( Key.TimeZone / 1e6 ), UnixTime, Day, Seconds );
+    Key.Instant = ( Kind == 'E' ) ? Day : ( UnixTime >= 0 ? UnixTime : UnixTime - 59 ) / 60;
+    return true;
+}
+//--------------------------------------------------------------------------------------------------
+static void Serve( int Socket, DaemonEvaluator* Evaluator ) {
+    // Every read is answered as one batch: all complete lines in the buffer go to the evaluator together
+    std::string Buffer;
+    char Chunk[4096];
+    std::vector<DaemonQuery> Queries;
+    std::vector<char> Kinds;
+    ssize_t n;
+    while( ( n = read( Socket, Chunk, sizeof( Chunk ) ) ) > 0 ) {
+        double t0 = Now();
+        Buffer.append( Chunk, ( size_t ) n );
+        size_t End = Buffer.rfind( '\n' );
+        if( Buffer.size() - ( End == std::string::npos ? 0 : End + 1 ) > DaemonMaxLine ) {
+            break; // no newline in sight
+        }
+        if( End == std::string::npos ) {
+            continue;
+        }
+        Queries.clear();
+        Kinds.clear();
+        for( size_t Start = 0; Start <= End; ) {
+            size_t Stop = Buffer.find( '\n', Start );
+            if( Stop - Start > DaemonMaxLine ) {
+                close( Socket );
+                return;
+            }
+            std::string Text( Buffer, Start, Stop - Start ); // one line, sscanf() must not run on into the next one
+            DaemonQuery q;
+            double Latitude, Longitude, TimeZone;
+            long long t;
+            char Kind = 0;
+            int Used = -1;
+            memset( &q, 0, sizeof( q ) );
+            if( sscanf( Text.c_str(), " %c %lf %lf %lf %lld %n", &Kind, &Latitude, &Longitude, &TimeZone, &t, &Used ) == 5 && Used == ( int ) Text.size() && ( Kind == 'P' || Kind == 'E' ) ) {
+                if( MakeKey( Kind, Latitude, Longitude, TimeZone, t, q.Key ) ) {
+                    Queries.push_back( q );
+                } else {
+                    Kind = '?';
+                }
+            } else {
+                Used = -1;
+                sscanf( Text.c_str(), " %c %n", &Kind, &Used );
+                Kind = ( Kind == 'S' && Used == ( int ) Text.size() ) ? 'S' : '?';
+            }
+            Kinds.push_back( Kind );
+            Start = Stop + 1;
+        }
+        Buffer.erase( 0, End + 1 );
+        if( !Queries.empty() ) {
+            Evaluator->Submit( &Queries[0], Queries.size() );
+        }
+        std::string Reply;
+        char Line[128];
+        for( size_t k = 0, q = 0; k < Kinds.size(); k++ ) {
+            if( Kinds[k] == 'P' ) {
+                snprintf( Line, sizeof( Line ), "%.6f %.6f\n", Queries[q].Value.Elevation, Queries[q].Value.Azimuth );
+                q++;
+            } else if( Kinds[k] == 'E' ) {
+                snprintf( Line, sizeof( Line ), "%.8f %.8f %.8f\n", Queries[q].Value.Sunrise, Queries[q].Value.Noon, Queries[q].Value.Sunset );
+                q++;
+            } else if( Kinds[k] == 'S' ) {
+                Reply += Evaluator->Stats(); // longer than Line
+                continue;
+            } else {
+                snprintf( Line, sizeof( Line ), "error\n" );
+            }
+            Reply += Line;
+        }
+        double Microseconds = ( Now() - t0 ) * 1e6;
+        for( size_t q = 0; q < Queries.size(); q++ ) {
+            Evaluator->Record( Microseconds );
+        }
+        if( !WriteAll( Socket, Reply ) ) {
+            break;
+        }
+    }
+    close( Socket );
+}
+//--------------------------------------------------------------------------------------------------
+static int Connect( const char* Path ) {
+    int Socket = socket( AF_UNIX, SOCK_STREAM, 0 );
+    sockaddr_un Address;
+    memset( &Address, 0, sizeof( Address ) );
+    Address.sun_family = AF_UNIX;
+    strncpy( Address.sun_path, Path, sizeof( Address.sun_path ) - 1 );
+    if( Socket >= 0 && connect( Socket, ( sockaddr* ) &Address, sizeof( Address ) ) != 0 ) {
+        close( Socket );
+        Socket = -1;
+    }
+    return Socket;
+}
+//--------------------------------------------------------------------------------------------------
+static int Server( const char* Path, size_t CacheEntries ) {
+    int Listener = socket( AF_UNIX, SOCK_STREAM, 0 );
+    sockaddr_un Address;
+    memset( &Address, 0, sizeof( Address ) );
+    Address.sun_family = AF_UNIX;
+    strncpy( Address.sun_path, Path, sizeof( Address.sun_path ) - 1 );
+    unlink( Path );
+    if( Listener < 0 || bind( Listener, ( sockaddr* ) &Address, sizeof( Address ) ) != 0 || listen( Listener, 64 ) != 0 ) {
+        printf( "cannot listen on %s\n", Path );
+        return 1;
+    }
+    signal( SIGPIPE, SIG_IGN );
+    DaemonEvaluator Evaluator( CacheEntries );
+    std::thread( &DaemonEvaluator::Run, &Evaluator ).detach();
+    printf( "listening on %s, cache of %lu entries\n", Path, ( unsigned long ) CacheEntries );
+    fflush( stdout );
+    for( ;; ) {
+        int Socket = accept( Listener, 0, 0 );
+        if( Socket >= 0 ) {
+            std::thread( Serve, Socket, &Evaluator ).detach();
+        }
+    }
+}
+//--------------------------------------------------------------------------------------------------
+static int Load( const char* Path, int Clients, long Queries ) {
+    // Every client asks for random minutes of one day at eight sites, 32 lines per write
+    std::vector<std::thread> Workers;
+    std::vector<long> Answers( Clients, 0 );
+    double t0 = Now();
+    for( int c = 0; c < Clients; c++ ) {
+        Workers.push_back( std::thread( [ Path, Queries, c, &Answers ]() {
+            int Socket = Connect( Path );
+            if( Socket < 0 ) {
+                return;
+            }
+            unsigned Seed = 12345u + c;
+            char Reply[8192];
+            for( long Sent = 0; Sent < Queries; ) {
+                std::string Request;
+                int Lines = 0;
+                for( ; Lines < 32 && Sent < Queries; Lines++, Sent++ ) {
+                    char Line[128];
+                    Seed = Seed * 1103515245u + 12345u;
+                    int Site = ( Seed >> 16 ) % 8;
+                    long long Time = 1750000000LL + ( ( Seed >> 4 ) % 1440 ) * 60;
+                    snprintf( Line, sizeof( Line ), "%c %.4f %.4f %.4f %lld\n", ( Seed & 1 ) ? 'P' : 'E', 40.0 + Site, 5.0 + Site, 0.5, Time );
+                    Request += Line;
+                }
+                if( !WriteAll( Socket, Request ) ) {
+                    break;
+                }
+                for( int Received = 0; Received < Lines; ) {
+                    ssize_t n = read( Socket, Reply, sizeof( Reply ) );
+                    if( n <= 0 ) {
+                        close( Socket );
+                        return;
+                    }
+                    Received += ( int ) std::count( Reply, Reply + n, '\n' );
+                }
+                Answers[c] += Lines;
+            }
+            close( Socket );
+        } ) );
+    }
+    long Total = 0;
+    for( int c = 0; c < Clients; c++ ) {
+        Workers[c].join();
+        Total += Answers[c];
+    }
+    double t1 = Now();
+    printf( "%d clients, %ld answers in %.2f s, %.0f queries/s\n", Clients, Total, t1 - t0, Total / ( t1 - t0 ) );
+    int Socket = Connect( Path );
+    if( Socket < 0 || !WriteAll( Socket, "S\n" ) ) {
+        printf( "cannot connect to %s\n", Path );
+        return 1;
+    }
+    char Stats[256];
+    ssize_t n = read( Socket, Stats, sizeof( Stats ) - 1 );
+    Stats[n > 0 ? n : 0] = 0;
+    printf( "server: %s", Stats );
+    close( Socket );
+    return 0;
+}
+//--------------------------------------------------------------------------------------------------
+int main( int argc, char** argv ) {
+    if( argc == 5 && strcmp( argv[1], "--load" ) == 0 ) {
+        return Load( argv[2], atoi( argv[3] ), atol( argv[4] ) );
+    }
+    if( argc == 4 && strcmp( argv[1], "--cache" ) == 0 ) {
+        return Server( argv[3], ( size_t ) atol( argv[2] ) );
+    }
+    if( argc == 2 ) {
+        return Server( argv[1], 100000 );
+    }
+    printf( "usage: %s [--cache Entries] socket\n       %s --load socket Clients Queries\n", argv[0], argv[0] );
+    return 1;
+}
+//--------------------------------------------------------------------------------------------------
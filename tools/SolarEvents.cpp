@@ -0,0 +1,265 @@
+#include "Solar.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Sun events for every site and every day of a range of years, host only (POSIX)
+//
+//   SolarEvents [--csv] [--threads N] sites.csv FirstYear LastYear output
+//
+// sites.csv has one site per line: time zone, latitude, longitude (lines starting with # are skipped).
+// Per site and day: sunrise, solar noon and sunset as a fraction of the day (local time like SunriseTime()), day length
+// in minutes and the elevation at solar noon. The (site x day) grid is cut into chunks of one site and up to
+// ChunkDays days, worker threads take the next chunk from an atomic counter and evaluate SolarCore.h by day number,
+// so the load balances itself whatever the mix of sites. Memory stays at a few chunks per thread for any grid.
+//
+// Binary output is columnar and can be mapped into memory: an EventsHeader, the site table (3 doubles per site) and
+// then one float column per value, each Sites x Days long with index site * Days + day. Workers write their chunk
+// straight to its place with pwrite(). CSV output is written in site/day order, chunks that finish early wait in a
+// reorder window of a few chunks per thread.
+
+//--------------------------------------------------------------------------------------------------
+struct EventsHeader {
+    char Magic[8];          // "SOLEVTS"
+    uint32_t Version;       // 1
+    uint32_t Sites;
+    uint32_t Days;
+    int32_t FirstDay;       // days since 1970-01-01 of the first day
+    uint32_t Columns;       // Sunrise, Noon, Sunset, DayLength, MaxElevation
+    uint32_t Reserved;
+    uint64_t SiteOffset;    // bytes from the start of the file
+    uint64_t ColumnOffset;
+};
+
+struct EventsSite {
+    double TimeZone;
+    double Latitude;
+    double Longitude;
+};
+
+enum { Sunrise, Noon, Sunset, DayLength, MaxElevation, Columns };
+
+static const int ChunkDays = 1024;
+
+//--------------------------------------------------------------------------------------------------
+class EventsGenerator {
+public:
+    EventsGenerator( const std::vector<EventsSite>& Sites, int32_t FirstDay, int32_t Days ) : m_Sites( Sites ) {
+        m_FirstDay = FirstDay;
+        m_Days     = Days;
+        m_Blocks   = ( Days + ChunkDays - 1 ) / ChunkDays;
+        m_Chunks   = ( long ) Sites.size() * m_Blocks;
+        m_Next     = 0;
+    }
+    bool Binary( const char* Path, int Threads );
+    bool Csv( const char* Path, int Threads );
+private:
+    int Chunk( long k, int& Site, int32_t& First );
+    void Compute( int Site, int32_t First, int Count, float* Values );
+    void BinaryWorker( int File, uint64_t ColumnOffset );
+    void CsvWorker( FILE* File, int Window );
+    const std::vector<EventsSite>& m_Sites;
+    int32_t m_FirstDay;
+    int32_t m_Days;
+    int m_Blocks;
+    long m_Chunks;
+    std::atomic<long> m_Next;
+    std::atomic<bool> m_Failed;
+    std::mutex m_Lock;      // CSV reorder window
+    std::condition_variable m_Written;
+    long m_Flushed;
+    std::vector<std::string> m_Slots;
+    std::vector<char> m_Ready;
+};
+//--------------------------------------------------------------------------------------------------
+int EventsGenerator::Chunk( long k, int& Site, int32_t& First ) { // returns the number of days in chunk k
+    Site  = ( int )( k / m_Blocks );
+    First = ( int32_t )( k % m_Blocks ) * ChunkDays;
+    return ( m_Days - First < ChunkDays ) ? m_Days - First : ChunkDays;
+}
+//--------------------------------------------------------------------------------------------------
+void EventsGenerator::Compute( int Site, int32_t First, int Count, float* Values ) {
+    // Values[column * Count + day], the date terms are taken at local noon like SunriseTime() does
+    const EventsSite& s = m_Sites[Site];
+    SolarSite Sun = SolarMakeSite( s.TimeZone, s.Latitude, s.Longitude );
+    int32_t UnixOffset = SolarUnixOffset( Sun );
+    for( int d = 0; d < Count; d++ ) {
+        int32_t DayNumber = m_FirstDay + First + d;
+        SunEvents Events = SolarEventsAt( Sun, DayNumber );
+        double Rise = Events.SunriseTime, Set = Events.SunsetTime, SolarNoon = Events.SolarNoon;
+        int64_t NoonTime = ( int64_t ) DayNumber * 86400 - UnixOffset + ( int64_t ) floor( SolarNoon * 86400.0 + 0.5 );
+        double Elevation = SolarPositionUnix( Sun, NoonTime ).SolarElevation;
+        double Length = ( Set - Rise ) * 1440.0;
+        if( isnan( Length ) ) { // polar day or night
+            Length = ( Elevation > 0.0 ) ? 1440.0 : 0.0;
+        }
+        Values[Sunrise * Count + d]      = ( float ) Rise;
+        Values[Noon * Count + d]         = ( float ) SolarNoon;
+        Values[Sunset * Count + d]       = ( float ) Set;
+        Values[DayLength * Count + d]    = ( float ) Length;
+        Values[MaxElevation * Count + d] = ( float ) Elevation;
+    }
+}
+//--------------------------------------------------------------------------------------------------
+void EventsGenerator::BinaryWorker( int File, uint64_t ColumnOffset ) {
+    std::vector<float> Values( Columns * ChunkDays );
+    uint64_t ColumnBytes = ( uint64_t ) m_Sites.size() * m_Days * sizeof( float );
+    for( long k = m_Next++; k < m_Chunks; k = m_Next++ ) {
+        int Site;
+        int32_t First;
+        int Count = Chunk( k, Site, First );
+        Compute( Site, First, Count, &Values[0] );
+        for( int c = 0; c < Columns; c++ ) {
+            uint64_t Offset = ColumnOffset + c * ColumnBytes + ( ( uint64_t ) Site * m_Days + First ) * sizeof( float );
+            size_t Bytes = Count * sizeof( float );
+            if( pwrite( File, &Values[c * Count], Bytes, ( off_t ) Offset ) != ( ssize_t ) Bytes ) {
+                m_Failed = true;
+            }
+        }
+    }
+}
+//--------------------------------------------------------------------------------------------------
+bool EventsGenerator::Binary( const char* Path, int Threads ) {
+    int File = open( Path, O_CREAT | O_TRUNC | O_WRONLY, 0644 );
+    if( File < 0 ) {
+        return false;
+    }
+    EventsHeader Header;
+    memset( &Header, 0, sizeof( Header ) );
+    memcpy( Header.Magic, "SOLEVTS", 8 );
+    Header.Version      = 1;
+    Header.Sites        = ( uint32_t ) m_Sites.size();
+    Header.Days         = ( uint32_t ) m_Days;
+    Header.FirstDay     = m_FirstDay;
+    Header.Columns      = Columns;
+    Header.SiteOffset   = 64;
+    Header.ColumnOffset = ( Header.SiteOffset + m_Sites.size() * sizeof( EventsSite ) + 63 ) / 64 * 64; // aligned for mapping
+    m_Failed = pwrite( File, &Header, sizeof( Header ), 0 ) != ( ssize_t ) sizeof( Header );
+    size_t SiteBytes = m_Sites.size() * sizeof( EventsSite );
+    m_Failed = m_Failed || pwrite( File, &m_Sites[0], SiteBytes, ( off_t ) Header.SiteOffset ) != ( ssize_t ) SiteBytes;
+    m_Next = 0;
+    std::vector<std::thread> Workers;
+    for( int t = 0; t < Threads; t++ ) {
+        Workers.push_back( std::thread( &EventsGenerator::BinaryWorker, this, File, Header.ColumnOffset ) );
+    }
+    for( size_t t = 0; t < Workers.size(); t++ ) {
+        Workers[t].join();
+    }
+    return close( File ) == 0 && !m_Failed;
+}
+//--------------------------------------------------------------------------------------------------
+void EventsGenerator::CsvWorker( FILE* File, int Window ) {
+    std::vector<float> Values( Columns * ChunkDays );
+    for( long k = m_Next++; k < m_Chunks; k = m_Next++ ) {
+        {
+            std::unique_lock<std::mutex> Lock( m_Lock ); // not more than Window chunks ahead of the writer
+            m_Written.wait( Lock, [ this, k, Window ]() { return k < m_Flushed + Window; } );
+        }
+        int Site;
+        int32_t First;
+        int Count = Chunk( k, Site, First );
+        Compute( Site, First, Count, &Values[0] );
+        std::string Text;
+        char Line[160];
+        for( int d = 0; d < Count; d++ ) {
+            int Year;
+            uint8_t Month, Day;
+            SolarCivilFromDays( m_FirstDay + First + d, Year, Month, Day );
+            snprintf( Line, sizeof( Line ), "%d,%04d-%02d-%02d,%.6f,%.6f,%.6f,%.2f,%.4f\n", Site, Year, Month, Day, Values[Sunrise * Count + d], Values[Noon * Count + d], Values[Sunset * Count + d], Values[DayLength * Count + d], Values[MaxElevation * Count + d] );
+            Text += Line;
+        }
+        std::lock_guard<std::mutex> Lock( m_Lock );
+        m_Slots[k % Window].swap( Text );
+        m_Ready[k % Window] = 1;
+        while( m_Ready[m_Flushed % Window] ) { // write every chunk that is next in line
+            std::string& Slot = m_Slots[m_Flushed % Window];
+            if( fwrite( Slot.data(), 1, Slot.size(), File ) != Slot.size() ) {
+                m_Failed = true;
+            }
+            std::string().swap( Slot );
+            m_Ready[m_Flushed % Window] = 0;
+            m_Flushed++;
+        }
+        m_Written.notify_all();
+    }
+}
+//--------------------------------------------------------------------------------------------------
+bool EventsGenerator::Csv( const char* Path, int Threads ) {
+    FILE* File = fopen( Path, "w" );
+    if( !File ) {
+        return false;
+    }
+    fprintf( File, "# site,date,sunrise,noon,sunset,daylength,maxelevation\n" );
+    int Window = 4 * Threads;
+    m_Slots.assign( Window, std::string() );
+    m_Ready.assign( Window, 0 );
+    m_Flushed = 0;
+    m_Next    = 0;
+    m_Failed  = false;
+    std::vector<std::thread> Workers;
+    for( int t = 0; t < Threads; t++ ) {
+        Workers.push_back( std::thread( &EventsGenerator::CsvWorker, this, File, Window ) );
+    }
+    for( size_t t = 0; t < Workers.size(); t++ ) {
+        Workers[t].join();
+    }
+    return fclose( File ) == 0 && !m_Failed;
+}
+//--------------------------------------------------------------------------------------------------
+static bool ReadSites( const char* Path, std::vector<EventsSite>& Sites ) {
+    FILE* f = fopen( Path, "r" );
+    if( !f ) {
+        return false;
+    }
+    char Line[256];
+    while( fgets( Line, sizeof( Line ), f ) ) {
+        EventsSite s;
+        if( Line[0] != '#' && sscanf( Line, "%lf,%lf,%lf", &s.TimeZone, &s.Latitude, &s.Longitude ) == 3 ) {
+            Sites.push_back( s );
+        }
+    }
+    fclose( f );
+    return !Sites.empty();
+}
+//--------------------------------------------------------------------------------------------------
+int main( int argc, char** argv ) {
+    bool Text = false;
+    int Threads = ( int ) std::thread::hardware_concurrency();
+    int a = 1;
+    for( ; a < argc && argv[a][0] == '-' && argv[a][1] == '-'; a++ ) {
+        if( strcmp( argv[a], "--csv" ) == 0 ) {
+            Text = true;
+        } else if( strcmp( argv[a], "--threads" ) == 0 && a + 1 < argc ) {
+            Threads = atoi( argv[++a] );
+        }
+    }
+    if( argc - a != 4 ) {
+        printf( "usage: %s [--csv] [--threads N] sites.csv FirstYear LastYear output\n", argv[0] );
+        return 1;
+    }
+    std::vector<EventsSite> Sites;
+    if( !ReadSites( argv[a], Sites ) ) {
+        printf( "no sites in %s\n", argv[a] );
+        return 1;
+    }
+    Threads = ( Threads < 1 ) ? 1 : Threads;
+    int32_t FirstDay = SolarDaysFromCivil( atoi( argv[a + 1] ), 1, 1 );
+    int32_t Days = SolarDaysFromCivil( atoi( argv[a + 2] ) + 1, 1, 1 ) - FirstDay;
+    EventsGenerator Generator( Sites, FirstDay, Days );
+    bool Done = Text ? Generator.Csv( argv[a + 3], Threads ) : Generator.Binary( argv[a + 3], Threads );
+    if( !Done ) {
+        printf( "cannot write %s\n", argv[a + 3] );
+        return 1;
+    }
+    printf( "%d sites x %d days written to %s\n", ( int ) Sites.size(), ( int ) Days, argv[a + 3] );
+    return 0;
+}
+//--------------------------------------------------------------------------------------------------